@@ -1,8 +1,10 @@
 #include "kosaraju_server.hpp"
 #include "proactor.hpp"
+#include "scc_tracker.hpp"
+#include "watch.hpp"
+#include "../scc/scc.hpp"
 #include <iostream>
 #include <vector>
-#include <stack>
 #include <cstring>
 #include <unistd.h>
 #include <sys/types.h>
@@ -30,27 +32,8 @@ bool mostGraphConnected = false;
 bool wasHalfInSCC = false;
 bool notHalfInSCC = false;
 
-void dfsUtil(int node, vector<bool>& visited, stack<int>& st) {
-    visited[node] = true;  // Mark the current node as visited
-    int n = adjMat.size();  // Get the number of nodes
-    for (int neighbor = 0; neighbor < n; ++neighbor) {
-        if (adjMat[node][neighbor] && !visited[neighbor]) {
-            dfsUtil(neighbor, visited, st);  // Recursively visit neighbors
-        }
-    }
-    st.push(node);  // Push the node to the stack after visiting all its neighbors
-}
+SCCTracker sccTracker;  // SCC labels kept up to date on every edit, protected by adjMatMutex
 
-void dfsReverseUtil(int node, vector<bool>& visited, vector<int>& component) {
-    visited[node] = true;  // Mark the current node as visited
-    component.push_back(node);  // Add the node to the current component
-    int n = adjMat.size();  // Get the number of nodes
-    for (int neighbor = 0; neighbor < n; ++neighbor) {
-        if (adjMat[neighbor][node] && !visited[neighbor]) {
-            dfsReverseUtil(neighbor, visited, component);  // Recursively visit neighbors in the reverse graph
-        }
-    }
-}
 vector<vector<int>> receiveGraph(int n, int m, int client_fd) {
     vector<vector<int>> adj(n, vector<int>(n, 0));  // Initialize adjacency matrix
     for (int i = 0; i < m; ++i) {
@@ -70,72 +53,28 @@ vector<vector<int>> receiveGraph(int n, int m, int client_fd) {
 }
 
 // Function to perform Kosaraju's algorithm to find strongly connected components (SCCs)
-vector<vector<int>> findSCCs(int n) {
-    vector<bool> visited(n, false);  // Vector to keep track of visited nodes
-    stack<int> st;  // Stack to store nodes in finishing order of DFS
-
-    // Perform DFS and fill the stack with nodes in finishing order
-    for (int i = 0; i < n; ++i) {
-        if (!visited[i]) {
-            dfsUtil(i, visited, st);  // Call DFS for unvisited nodes
-        }
-    }
-
-    // Create a transposed (reverse) adjacency matrix
-    vector<vector<int>> reverseAdjMat(n, vector<int>(n, 0));
-    for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            reverseAdjMat[i][j] = adjMat[j][i];  // Reverse the edges of the graph
-        }
-    }
-
-    fill(visited.begin(), visited.end(), false);  // Reset the visited vector for the second DFS
-    vector<vector<int>> SCC;  // Vector to store all strongly connected components
-
-    // Process all nodes in the order defined by the stack
-    while (!st.empty()) {
-        int node = st.top();
-        st.pop();
-        if (!visited[node]) {
-            vector<int> component;  // Vector to store the current component
-            dfsReverseUtil(node, visited, component);  // Perform DFS on the transposed graph
-            SCC.push_back(component);  // Add the component to the list of SCCs
-        }
-    }
-
-    return SCC;  // Return the list of strongly connected components
+vector<vector<int>> findSCCs() {
+    return scc::find(scc::MatrixGraph(adjMat)).toVectors();  // Iterative Kosaraju of the shared SCC library
 }
-// Function to print strongly connected components (SCCs) and update the status of the graph
-void printSCCs(const vector<vector<int>>& scc, int client_fd) {
-    bool foundMajority = false;  // Flag to indicate if any SCC contains more than half of the nodes
+// Function to signal the monitor when the largest SCC crosses half of the graph (call with adjMatMutex held)
+void publishMajority() {
+    bool majority = trackerLargestSCC(sccTracker) > (int)adjMat.size() / 2;  // Same test Kosaraju used
 
-    // Lock the mutex to ensure thread safety
     pthread_mutex_lock(&mutexCondition);
-
-    // Iterate through each SCC to check if it contains more than half of the nodes
-    for (int i = 0; i < scc.size(); ++i) {
-        if (scc[i].size() > adjMat.size() / 2) {
-            mostGraphConnected = true;  // Set the flag indicating most of the graph is connected in one SCC
-            wasHalfInSCC = true;  // Set the flag indicating we found an SCC with more than half nodes
-            foundMajority = true;  // Mark that we found such an SCC
-            pthread_cond_signal(&cond);  // Signal the condition variable to wake up any waiting threads
-            break;  // Exit the loop as we found the desired SCC
-        }
-    }
-
-    // Print the status of the foundMajority and wasHalfInSCC flags
-    std::cout << "foundMajority: " << foundMajority << std::endl;
-    std::cout << "wasMajority: " << wasHalfInSCC << std::endl;
-
-    // If no majority SCC was found but previously it was, update the notHalfInSCC flag
-    if (foundMajority == false && wasHalfInSCC == true) {
-        notHalfInSCC = true;  // Set the flag indicating that the graph is no longer half in one SCC
-        pthread_cond_signal(&cond);  // Signal the condition variable to wake up any waiting threads
+    if (majority && !wasHalfInSCC) {
+        mostGraphConnected = true;  // Most of the graph just became one SCC
+        wasHalfInSCC = true;
+        pthread_cond_signal(&cond);  // Wake up the monitor thread
+    } else if (!majority && wasHalfInSCC) {
+        notHalfInSCC = true;  // The majority SCC just fell apart
+        wasHalfInSCC = false;
+        pthread_cond_signal(&cond);  // Wake up the monitor thread
     }
-
-    // Unlock the mutex after the updates
     pthread_mutex_unlock(&mutexCondition);
+}
 
+// Function to send strongly connected components (SCCs) to the client
+void printSCCs(const vector<vector<int>>& scc, int client_fd) {
     // Iterate through each SCC to send its components to the client
     for (const auto& component : scc) {
         string result;
@@ -168,13 +107,16 @@ void handleClient(const string& command, int client_fd) {
             // Lock the adjacency matrix while updating it
             lock_guard<mutex> lock(adjMatMutex);
             adjMat = receiveGraph(n, m, client_fd);
+            trackerRebuild(sccTracker, adjMat);  // Label the new graph once
+            publishMajority();
+            notifyWatchers();
 
         // Check if the command starts with "Kosaraju"
         } else if (command.substr(0, 8) == "Kosaraju") {
             cout << "Processing Kosaraju command" << endl;
             // Lock the adjacency matrix while reading it
             lock_guard<mutex> lock(adjMatMutex);
-            vector<vector<int>> scc = findSCCs(adjMat.size());
+            vector<vector<int>> scc = findSCCs();
             printSCCs(scc, client_fd);
 
         // Check if the command starts with "Newedge"
@@ -188,7 +130,16 @@ void handleClient(const string& command, int client_fd) {
             // Lock the adjacency matrix while updating it
             {
                 lock_guard<mutex> lock(adjMatMutex);
-                adjMat[u-1][v-1] = 1;
+                if (u < 1 || u > (int)adjMat.size() || v < 1 || v > (int)adjMat.size()) {
+                    send(client_fd, "Invalid edge\n", 13, 0);
+                    return;
+                }
+                if (!adjMat[u-1][v-1]) {
+                    adjMat[u-1][v-1] = 1;
+                    trackerEdgeAdded(sccTracker, adjMat, u-1, v-1);  // May merge SCCs
+                    publishMajority();
+                    notifyWatchers();
+                }
             }
             send(client_fd, "Edge added\n", 11, 0);
 
@@ -203,10 +154,31 @@ void handleClient(const string& command, int client_fd) {
             // Lock the adjacency matrix while updating it
             {
                 lock_guard<mutex> lock(adjMatMutex);
-                adjMat[u-1][v-1] = 0;
+                if (u < 1 || u > (int)adjMat.size() || v < 1 || v > (int)adjMat.size()) {
+                    send(client_fd, "Invalid edge\n", 13, 0);
+                    return;
+                }
+                if (adjMat[u-1][v-1]) {
+                    adjMat[u-1][v-1] = 0;
+                    trackerEdgeRemoved(sccTracker, adjMat, u-1, v-1);  // May split the SCC of the edge
+                    publishMajority();
+                    notifyWatchers();
+                }
             }
             send(client_fd, "Edge removed\n", 13, 0);
 
+        // Check if the command starts with "Unwatch"
+        } else if (command.substr(0, 7) == "Unwatch") {
+            cout << "Processing Unwatch command" << endl;
+            string response = removeWatch(stoi(command.substr(8)), client_fd);
+            send(client_fd, response.c_str(), response.size(), 0);
+
+        // Check if the command starts with "Watch"
+        } else if (command.substr(0, 5) == "Watch") {
+            cout << "Processing Watch command" << endl;
+            string response = addWatch(command.substr(5), client_fd);
+            send(client_fd, response.c_str(), response.size(), 0);
+
         // Handle invalid commands
         } else {
             cout << "Invalid command: " << command << endl;
@@ -289,6 +261,7 @@ void* proactorThread(int client_fd) {
                 // If nbytes is less than 0, an error occurred
                 perror("recv");
             }
+            dropWatches(client_fd);  // Nobody is left to notify
             close(client_fd);  // Close the socket connection with the client
             break;  // Exit the loop and end the thread
         } else {
@@ -312,26 +285,25 @@ void* monitorSCC(void* arg) {
         // Store the current states of the conditions locally
         bool localMostGraphConnected = mostGraphConnected;
         bool localNotLongerInSCC = notHalfInSCC;
+        bool localHalfInSCC = wasHalfInSCC;  // Current state, only publishMajority writes it
 
-        // Update the global conditions based on the current state
-        if (mostGraphConnected) {
-            mostGraphConnected = false;  // Reset the global condition
-            wasHalfInSCC = true;  // Update the state to indicate more than half is in one SCC
-        }
-
-        if (notHalfInSCC) {
-            notHalfInSCC = false;  // Reset the global condition
-            wasHalfInSCC = false;  // Update the state to indicate less than half is in one SCC
-        }
+        // Reset the global conditions
+        mostGraphConnected = false;
+        notHalfInSCC = false;
 
         pthread_mutex_unlock(&mutexCondition);  // Unlock the mutex after updating shared variables
         
-        // Print the appropriate message based on the local state
+        // Print the appropriate message based on the local state; if both happened since the last wakeup,
+        // the message of the current state comes last
+        if (localNotLongerInSCC && localHalfInSCC) {
+            cout << "At least 50% of the graph NO LONGER belongs to the same SCC\n";
+        }
+
         if (localMostGraphConnected) {
             cout << "At least 50% of the graph belongs to the same SCC\n";
         }
 
-        if (localNotLongerInSCC) {
+        if (localNotLongerInSCC && !localHalfInSCC) {
             cout << "At least 50% of the graph NO LONGER belongs to the same SCC\n";
         }
     }
@@ -363,6 +335,12 @@ int main() {
         return 1;
     }
 
+    pthread_t watcher;
+    if (pthread_create(&watcher, nullptr, watchWorker, nullptr) != 0) {  // Create the watch evaluation thread
+        cerr << "Error: Failed to create watch thread" << endl;
+        return 1;
+    }
+
     cout << "Waiting for connections..." << endl;
 
     while (true) {
@@ -381,10 +359,8 @@ int main() {
                     if (newfd == -1) {
                         cerr << "Error: Accept function failed" << endl;
                     } else {
-                        FD_SET(newfd, &master);  // Add new client to master set
-                        if (newfd > fdmax) {
-                            fdmax = newfd;  // Update max file descriptor
-                        }
+                        // The proactor thread owns the client socket from here on; reading it in this
+                        // loop as well would hand every other command (and the edges of Newgraph) to the wrong reader
                         cout << "New connection from " << inet_ntoa(((struct sockaddr_in *)&remoteaddr)->sin_addr) << endl;
 
                         pthread_t tid = startProactor(newfd, proactorThread);  // Start proactor thread
@@ -2,29 +2,32 @@
 #define KOSARAJU_SERVER_HPP
 
 #include <vector>
-#include <stack>
 #include <mutex>
 #include <condition_variable>
 #include <map>
+#include <string>
+#include "scc_tracker.hpp"
 
 struct ClientInfo {
     int client_fd;
     pthread_t thread_id;
 };
 
-// Function to perform depth-first search
-void dfsUtil(int node, std::vector<bool>& visited, std::stack<int>& st);
-
-// Function to perform depth-first search on the reverse graph
-void dfsReverseUtil(int node, std::vector<bool>& visited, std::vector<int>& component);
+// Global graph state shared with the watch worker
+extern std::vector<std::vector<int>> adjMat;  // Adjacency matrix of the graph
+extern std::mutex adjMatMutex;  // Mutex protecting adjMat and sccTracker
+extern SCCTracker sccTracker;  // SCC labels kept up to date on every edit
 
 // Function to perform Kosaraju's algorithm to find strongly connected components
-std::vector<std::vector<int>> findSCCs(int n);
+std::vector<std::vector<int>> findSCCs();
 
 // Function to receive the graph input from the client
 std::vector<std::vector<int>> receiveGraph(int n, int m, int client_fd);
 
-// Function to print strongly connected components
+// Function to signal the monitor when the largest SCC crosses half of the graph
+void publishMajority();
+
+// Function to send strongly connected components to the client
 void printSCCs(const std::vector<std::vector<int>>& scc, int client_fd);
 
 // Function to handle client commands
@@ -0,0 +1,136 @@
+#include "scc_tracker.hpp"
+#include "../scc/scc.hpp"
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+// Function to split a set of vertices into its SCCs, using only the edges inside the set (Kosaraju)
+static vector<vector<int>> sccsWithin(const vector<vector<int>>& adj, const vector<int>& members) {
+    scc::Components parts = scc::find(scc::MatrixGraph(adj, &members));  // Components as positions in members
+    vector<vector<int>> result(parts.size());
+    for (int c = 0; c < parts.size(); ++c) {
+        for (const int* x = parts.begin(c); x != parts.end(c); ++x) {
+            result[c].push_back(members[*x]);
+        }
+    }
+    return result;
+}
+
+// Function to take an unused label
+static int allocateLabel(SCCTracker& tracker) {
+    if (!tracker.freeLabels.empty()) {
+        int label = tracker.freeLabels.back();
+        tracker.freeLabels.pop_back();
+        return label;
+    }
+    tracker.size.push_back(0);
+    return tracker.size.size() - 1;
+}
+
+// Function to move a vertex to another label, releasing the old label when it becomes empty
+static void relabel(SCCTracker& tracker, int vertex, int label) {
+    int old = tracker.label[vertex];
+    if (old == label) {
+        return;
+    }
+    if (--tracker.size[old] == 0) {
+        tracker.freeLabels.push_back(old);
+    }
+    tracker.label[vertex] = label;
+    tracker.size[label]++;
+}
+
+// Function to label all SCCs of the graph from scratch
+void trackerRebuild(SCCTracker& tracker, const vector<vector<int>>& adj) {
+    int n = adj.size();
+    vector<int> all(n);
+    for (int i = 0; i < n; ++i) {
+        all[i] = i;
+    }
+    vector<vector<int>> sccs = sccsWithin(adj, all);
+    tracker.label.assign(n, 0);
+    tracker.size.assign(sccs.size(), 0);
+    tracker.freeLabels.clear();
+    for (size_t c = 0; c < sccs.size(); ++c) {
+        for (int vertex : sccs[c]) {
+            tracker.label[vertex] = c;
+        }
+        tracker.size[c] = sccs[c].size();
+    }
+}
+
+// Function to update the labels after the edge u -> v was added (0-based, adj already updated)
+void trackerEdgeAdded(SCCTracker& tracker, const vector<vector<int>>& adj, int u, int v) {
+    if (tracker.label[u] == tracker.label[v]) {
+        return;  // An edge inside one SCC changes nothing
+    }
+
+    // The new edge closes a cycle only if v already reaches u
+    int n = adj.size();
+    vector<bool> forward(n, false);
+    vector<int> queue(1, v);
+    forward[v] = true;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int x = queue[head];
+        for (int y = 0; y < n; ++y) {
+            if (adj[x][y] && !forward[y]) {
+                forward[y] = true;
+                queue.push_back(y);
+            }
+        }
+    }
+    if (!forward[u]) {
+        return;
+    }
+
+    // Every vertex reachable from v that also reaches u joins the SCC of u
+    vector<bool> backward(n, false);
+    queue.assign(1, u);
+    backward[u] = true;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int x = queue[head];
+        for (int y = 0; y < n; ++y) {
+            if (adj[y][x] && forward[y] && !backward[y]) {
+                backward[y] = true;
+                queue.push_back(y);
+            }
+        }
+    }
+    int merged = tracker.label[u];
+    for (int x : queue) {
+        relabel(tracker, x, merged);
+    }
+}
+
+// Function to update the labels after the edge u -> v was removed (0-based, adj already updated)
+void trackerEdgeRemoved(SCCTracker& tracker, const vector<vector<int>>& adj, int u, int v) {
+    int old = tracker.label[u];
+    if (old != tracker.label[v]) {
+        return;  // An edge between two SCCs cannot split anything
+    }
+
+    // Only the SCC that contained the edge can split; recompute it on its own
+    vector<int> members;
+    for (size_t x = 0; x < tracker.label.size(); ++x) {
+        if (tracker.label[x] == old) {
+            members.push_back(x);
+        }
+    }
+    vector<vector<int>> parts = sccsWithin(adj, members);
+    for (size_t p = 1; p < parts.size(); ++p) {  // The first part keeps the old label
+        int label = allocateLabel(tracker);
+        for (int x : parts[p]) {
+            relabel(tracker, x, label);
+        }
+    }
+}
+
+// Function to return the size of the largest SCC
+int trackerLargestSCC(const SCCTracker& tracker) {
+    int largest = 0;
+    for (int s : tracker.size) {
+        largest = max(largest, s);
+    }
+    return largest;
+}
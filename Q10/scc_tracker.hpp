@@ -0,0 +1,25 @@
+#ifndef SCC_TRACKER_HPP
+#define SCC_TRACKER_HPP
+
+#include <vector>
+
+// SCC labels of the adjacency matrix, kept up to date edge by edge
+struct SCCTracker {
+    std::vector<int> label;      // SCC label of every vertex
+    std::vector<int> size;       // Number of vertices carrying every label (0 for unused labels)
+    std::vector<int> freeLabels; // Labels that are currently unused
+};
+
+// Function to label all SCCs of the graph from scratch
+void trackerRebuild(SCCTracker& tracker, const std::vector<std::vector<int>>& adj);
+
+// Function to update the labels after the edge u -> v was added (0-based, adj already updated)
+void trackerEdgeAdded(SCCTracker& tracker, const std::vector<std::vector<int>>& adj, int u, int v);
+
+// Function to update the labels after the edge u -> v was removed (0-based, adj already updated)
+void trackerEdgeRemoved(SCCTracker& tracker, const std::vector<std::vector<int>>& adj, int u, int v);
+
+// Function to return the size of the largest SCC
+int trackerLargestSCC(const SCCTracker& tracker);
+
+#endif // SCC_TRACKER_HPP
@@ -0,0 +1,282 @@
+#include "watch.hpp"
+#include "kosaraju_server.hpp"
+#include "scc_tracker.hpp"
+#include <iostream>
+#include <sstream>
+#include <map>
+#include <vector>
+#include <cctype>
+#include <cstdlib>
+#include <cerrno>
+#include <ctime>
+#include <sys/socket.h>
+
+using namespace std;
+
+// Kinds of conditions a client can watch
+enum WatchKind { WATCH_GIANT, WATCH_SCCCOUNT, WATCH_SAMECOMP };
+
+// A registered watch and the value it had at the last evaluation
+struct Watch {
+    int client_fd;       // Client that receives the notifications
+    unsigned long client;  // Id of that connection, tells a reused fd apart from it
+    WatchKind kind;      // What is measured
+    string op;           // Comparison operator for GIANT and SCCCOUNT
+    double threshold;    // Right hand side of the comparison
+    int u, v;            // Vertices for SAMECOMP (1-based)
+    string text;         // Expression as the client wrote it
+    bool last;           // Value at the last evaluation
+    unsigned long generation;  // Edit generation last was measured at
+};
+
+// Graph measurements a watch is evaluated against
+struct WatchSnapshot {
+    unsigned long generation;  // Edit generation of the graph these were taken from
+    int vertices;
+    int largest;
+    int sccCount;
+    vector<int> label;
+};
+
+// A connection with watches and the notifications it has not taken yet
+struct WatchClient {
+    unsigned long id;    // Source: nextClientId; the fd alone may already belong to someone else
+    string pending;      // Unsent notifications, pushed without blocking whenever the socket takes them
+};
+
+// Notifications beyond this many unsent bytes are dropped, so a client that stops reading cannot grow memory
+const size_t MAX_PENDING_BYTES = 64 * 1024;
+// How often unsent notifications are retried while no edits arrive, in milliseconds
+const long PENDING_RETRY_MS = 50;
+
+map<int, Watch> watches;  // Registered watches by id
+map<int, WatchClient> watchClients;  // Connections with watches by fd
+int nextWatchId = 1;
+unsigned long nextClientId = 1;
+unsigned long editGeneration = 0;  // Bumped on every edit
+unsigned long evaluatedGeneration = 0;  // Generation the watches were last evaluated at
+pthread_mutex_t watchMutex = PTHREAD_MUTEX_INITIALIZER;  // Protects everything above
+pthread_cond_t watchCond = PTHREAD_COND_INITIALIZER;  // Signaled when editGeneration changes
+
+// Function to take the measurements of the current graph
+static WatchSnapshot takeSnapshot() {
+    WatchSnapshot snap;
+    lock_guard<mutex> lock(adjMatMutex);
+    pthread_mutex_lock(&watchMutex);  // Edits bump the generation with adjMatMutex held, so it matches the graph
+    snap.generation = editGeneration;
+    pthread_mutex_unlock(&watchMutex);
+    snap.vertices = adjMat.size();
+    snap.largest = snap.vertices > 0 ? trackerLargestSCC(sccTracker) : 0;
+    snap.sccCount = sccTracker.size.size() - sccTracker.freeLabels.size();
+    snap.label = sccTracker.label;
+    return snap;
+}
+
+// Function to compare two values with the watch operator
+static bool compare(double value, const string& op, double threshold) {
+    if (op == ">=") return value >= threshold;
+    if (op == ">") return value > threshold;
+    if (op == "<=") return value <= threshold;
+    return value < threshold;
+}
+
+// Function to evaluate one watch against the measurements
+static bool evaluate(const Watch& w, const WatchSnapshot& snap) {
+    switch (w.kind) {
+        case WATCH_GIANT:
+            return compare(snap.vertices > 0 ? (double)snap.largest / snap.vertices : 0.0, w.op, w.threshold);
+        case WATCH_SCCCOUNT:
+            return compare(snap.sccCount, w.op, w.threshold);
+        case WATCH_SAMECOMP:
+            return w.u >= 1 && w.u <= snap.vertices && w.v >= 1 && w.v <= snap.vertices &&
+                   snap.label[w.u - 1] == snap.label[w.v - 1];
+    }
+    return false;
+}
+
+// Function to parse a watch expression; returns false if it is malformed
+static bool parseWatch(const string& expression, Watch& w) {
+    istringstream iss(expression);
+    string first;
+    iss >> first;
+    if (first == "samecomp") {
+        w.kind = WATCH_SAMECOMP;
+        return static_cast<bool>(iss >> w.u >> w.v);
+    }
+
+    string compact;  // "giant >= 0.5" and "giant>=0.5" are the same expression
+    for (char c : expression) {
+        if (!isspace(static_cast<unsigned char>(c))) {
+            compact += c;
+        }
+    }
+    size_t opPos = compact.find_first_of("<>");
+    if (opPos == string::npos) {
+        return false;
+    }
+    string metric = compact.substr(0, opPos);
+    size_t valuePos = opPos + 1;
+    w.op = compact.substr(opPos, 1);
+    if (valuePos < compact.size() && compact[valuePos] == '=') {
+        w.op += "=";
+        valuePos++;
+    }
+    if (metric == "giant") {
+        w.kind = WATCH_GIANT;
+    } else if (metric == "scccount") {
+        w.kind = WATCH_SCCCOUNT;
+    } else {
+        return false;
+    }
+    char* end;
+    w.threshold = strtod(compact.c_str() + valuePos, &end);
+    return end != compact.c_str() + valuePos && *end == '\0';
+}
+
+// Function to register a watch for a client
+string addWatch(const string& expression, int client_fd) {
+    Watch w;
+    w.client_fd = client_fd;
+    size_t first = expression.find_first_not_of(" \t\r\n");
+    size_t last = expression.find_last_not_of(" \t\r\n");
+    w.text = first == string::npos ? "" : expression.substr(first, last - first + 1);
+    if (!parseWatch(expression, w)) {
+        return "Invalid watch. Use: Watch giant>=0.5 | Watch scccount<100 | Watch samecomp u v\n";
+    }
+    WatchSnapshot snap = takeSnapshot();
+    w.last = evaluate(w, snap);  // Only later flips are pushed
+    w.generation = snap.generation;
+
+    pthread_mutex_lock(&watchMutex);
+    auto client = watchClients.find(client_fd);
+    if (client == watchClients.end()) {  // First watch of this connection
+        client = watchClients.insert(make_pair(client_fd, WatchClient{nextClientId++, ""})).first;
+    }
+    w.client = client->second.id;
+    int id = nextWatchId++;
+    watches[id] = w;
+    pthread_mutex_unlock(&watchMutex);
+
+    return "Watch " + to_string(id) + " registered (" + w.text + " is " + (w.last ? "true" : "false") + ")\n";
+}
+
+// Function to remove a watch owned by the client
+string removeWatch(int id, int client_fd) {
+    pthread_mutex_lock(&watchMutex);
+    auto it = watches.find(id);
+    bool found = it != watches.end() && it->second.client_fd == client_fd;
+    if (found) {
+        watches.erase(it);
+    }
+    pthread_mutex_unlock(&watchMutex);
+    return found ? "Watch " + to_string(id) + " removed\n" : "No such watch\n";
+}
+
+// Function to remove all watches of a disconnected client
+void dropWatches(int client_fd) {
+    pthread_mutex_lock(&watchMutex);
+    for (auto it = watches.begin(); it != watches.end(); ) {
+        if (it->second.client_fd == client_fd) {
+            it = watches.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    watchClients.erase(client_fd);  // Unsent notifications must not reach whoever gets the fd next
+    pthread_mutex_unlock(&watchMutex);
+}
+
+// Function to tell the watch worker that the graph changed
+void notifyWatchers() {
+    pthread_mutex_lock(&watchMutex);
+    editGeneration++;
+    pthread_cond_signal(&watchCond);  // Wake up the worker if it is idle
+    pthread_mutex_unlock(&watchMutex);
+}
+
+// Function to push unsent notifications without blocking; whatever a full socket does not take stays
+// queued (watchMutex held, so a client cannot drop its watches and close its fd during the send)
+static void flushNotifications() {
+    for (auto& entry : watchClients) {
+        string& pending = entry.second.pending;
+        if (pending.empty()) {
+            continue;
+        }
+        ssize_t sent = send(entry.first, pending.data(), pending.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent > 0) {
+            pending.erase(0, sent);
+        } else if (sent == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            pending.clear();  // The client is going away, its thread drops the watches
+        }
+    }
+}
+
+// Function to check whether a notification is still waiting for a socket (watchMutex held)
+static bool notificationsPending() {
+    for (const auto& entry : watchClients) {
+        if (!entry.second.pending.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Function run by the background thread that evaluates the watches after edits.
+// Edits that arrive while an evaluation runs are folded into the next one.
+void* watchWorker(void* arg) {
+    while (true) {
+        pthread_mutex_lock(&watchMutex);
+        while (evaluatedGeneration == editGeneration) {
+            if (!notificationsPending()) {
+                pthread_cond_wait(&watchCond, &watchMutex);  // Sleep until something changed
+                continue;
+            }
+            struct timespec deadline;  // A slow client gets its notifications once its socket drains
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += PENDING_RETRY_MS * 1000000;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000;
+            deadline.tv_nsec %= 1000000000;
+            pthread_cond_timedwait(&watchCond, &watchMutex, &deadline);
+            flushNotifications();
+        }
+        unsigned long generation = editGeneration;  // Everything up to here is covered by this evaluation
+        bool any = !watches.empty();
+        pthread_mutex_unlock(&watchMutex);
+
+        WatchSnapshot snap;
+        if (any) {
+            snap = takeSnapshot();
+            generation = snap.generation;  // The snapshot may already include later edits
+        }
+
+        pthread_mutex_lock(&watchMutex);
+        if (any) {
+            for (auto& entry : watches) {
+                Watch& w = entry.second;
+                if (w.generation > snap.generation) {
+                    continue;  // Registered after this snapshot was taken, its value is newer already
+                }
+                bool now = evaluate(w, snap);
+                if (now == w.last) {
+                    continue;
+                }
+                w.last = now;
+                w.generation = snap.generation;
+                auto client = watchClients.find(w.client_fd);
+                if (client == watchClients.end() || client->second.id != w.client) {
+                    continue;  // The connection is gone
+                }
+                string note = "Watch " + to_string(entry.first) + " [" + w.text + "] is now " + (now ? "true" : "false") + "\n";
+                if (client->second.pending.size() + note.size() > MAX_PENDING_BYTES) {
+                    cerr << "Watch " << entry.first << ": socket " << w.client_fd << " is not reading, notification dropped" << endl;
+                    continue;
+                }
+                client->second.pending += note;  // Queued behind what the client has not taken yet
+            }
+        }
+        evaluatedGeneration = generation;
+        flushNotifications();  // Under the lock, with MSG_DONTWAIT it never waits for a client
+        pthread_mutex_unlock(&watchMutex);
+    }
+    return nullptr;
+}
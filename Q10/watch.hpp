@@ -0,0 +1,22 @@
+#ifndef WATCH_HPP
+#define WATCH_HPP
+
+#include <string>
+
+// Function to register a watch for a client, e.g. "giant>=0.5", "scccount<100" or "samecomp 3 7".
+// Returns the response for the client.
+std::string addWatch(const std::string& expression, int client_fd);
+
+// Function to remove a watch owned by the client
+std::string removeWatch(int id, int client_fd);
+
+// Function to remove all watches of a disconnected client
+void dropWatches(int client_fd);
+
+// Function to tell the watch worker that the graph changed (cheap, safe to call on every edit)
+void notifyWatchers();
+
+// Function run by the background thread that evaluates the watches after edits
+void* watchWorker(void* arg);
+
+#endif // WATCH_HPP
@@ -0,0 +1,237 @@
+// external_sort.cpp
+// External merge sort of edge lists that do not fit into RAM, shared by the external-memory and compressed
+// variants: edges are collected in blocks of bounded size, every block is sorted and written to a run file,
+// and a k-way merge hands them to a sink in order. With more runs than file descriptors the merge takes
+// several passes. A graph that fits into one block never touches the disk.
+
+#include "kosaraju_scc.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <queue>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Function to order edges by source, then by target
+static bool operator<(const ExternalEdge& a, const ExternalEdge& b) {
+    return a.from != b.from ? a.from < b.from : a.to < b.to;
+}
+
+// Descriptors a merge pass leaves to everything but its input runs: stdio, the output file and some slack
+static const size_t RESERVED_FDS = 8;
+
+// Function to create an empty file in tmpDir whose name no other process uses; returns NULL on failure
+FILE* createTempExternal(const string& tmpDir, const string& name, string& path) {
+    string pattern = tmpDir + "/kosaraju_" + name + "_XXXXXX";
+    vector<char> buffer(pattern.begin(), pattern.end());
+    buffer.push_back('\0');
+    int fd = mkstemp(buffer.data());
+    if (fd == -1) {
+        perror("mkstemp");
+        return NULL;
+    }
+    path = buffer.data();
+    FILE* file = fdopen(fd, "wb");
+    if (file == NULL) {
+        perror("fdopen");
+        close(fd);
+        unlink(path.c_str());
+    }
+    return file;
+}
+
+// Function to write count items; a short write (e.g. a full disk) is an error, not a shorter file
+bool writeExternal(const void* data, size_t size, size_t count, FILE* file) {
+    if (count > 0 && fwrite(data, size, count, file) != count) {
+        perror("fwrite");
+        return false;
+    }
+    return true;
+}
+
+// Function to close a written file; stdio flushes its buffer here, so closing can fail too
+bool closeExternal(FILE* file) {
+    if (fclose(file) != 0) {
+        perror("fclose");
+        return false;
+    }
+    return true;
+}
+
+// Function to remove temporary files
+static void removeExternal(const vector<string>& paths) {
+    for (size_t i = 0; i < paths.size(); ++i) {
+        unlink(paths[i].c_str());
+    }
+}
+
+// Function to find how many runs one merge pass can keep open: the descriptor limit less RESERVED_FDS
+static size_t mergeFanInExternal() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) {
+        return 1024;
+    }
+    return limit.rlim_cur > RESERVED_FDS + 2 ? limit.rlim_cur - RESERVED_FDS : 2;
+}
+
+// Buffered reader over one sorted run file, used by the k-way merge
+struct RunReader {
+    FILE* file;
+    vector<ExternalEdge> buffer;
+    size_t pos;
+    size_t size;
+
+    bool refill() {
+        size = fread(buffer.data(), sizeof(ExternalEdge), buffer.size(), file);
+        pos = 0;
+        return size > 0;
+    }
+};
+
+// Receiver that writes whole edges to a file, used by the merge passes before the last one
+struct RunSinkExternal : EdgeSinkExternal {
+    FILE* file;
+    vector<ExternalEdge> buffer;
+
+    RunSinkExternal(FILE* file, size_t bufferEdges) : file(file) { buffer.reserve(bufferEdges); }
+
+    bool edge(const ExternalEdge& edge) {
+        buffer.push_back(edge);
+        return buffer.size() < buffer.capacity() || flush();
+    }
+
+    bool flush() {
+        bool written = writeExternal(buffer.data(), sizeof(ExternalEdge), buffer.size(), file);
+        buffer.clear();
+        return written;
+    }
+};
+
+// Function to merge the sorted runs [first, last) into sink with one buffer of bufferEdges per run
+static bool mergeRunsExternal(const vector<string>& runPaths, size_t first, size_t last, size_t bufferEdges,
+                              EdgeSinkExternal& sink) {
+    vector<RunReader> runs(last - first);
+    typedef pair<ExternalEdge, size_t> HeapItem;  // Edge and the run it came from
+    auto greater = [](const HeapItem& a, const HeapItem& b) { return b.first < a.first; };
+    priority_queue<HeapItem, vector<HeapItem>, decltype(greater)> heap(greater);
+    bool ok = true;
+    size_t opened = 0;
+    for (; opened < runs.size(); ++opened) {
+        runs[opened].file = fopen(runPaths[first + opened].c_str(), "rb");
+        if (runs[opened].file == NULL) {  // Skipping the run would silently drop its edges
+            perror("fopen");
+            ok = false;
+            break;
+        }
+        runs[opened].buffer.resize(bufferEdges);
+        if (runs[opened].refill()) {
+            heap.push(make_pair(runs[opened].buffer[runs[opened].pos++], opened));
+        }
+    }
+
+    while (ok && !heap.empty()) {
+        HeapItem top = heap.top();
+        heap.pop();
+        ok = sink.edge(top.first);
+        RunReader& run = runs[top.second];
+        if (run.pos < run.size || run.refill()) {
+            heap.push(make_pair(run.buffer[run.pos++], top.second));
+        }
+    }
+
+    for (size_t r = 0; r < opened; ++r) {
+        if (ok && ferror(runs[r].file)) {  // A failed read ends a run early, just like its end
+            cerr << "Error reading " << runPaths[first + r] << endl;
+            ok = false;
+        }
+        fclose(runs[r].file);
+    }
+    return ok;
+}
+
+// Function to merge sorted runs into sink. While there are more runs than descriptors to open them with,
+// groups of them are merged into longer runs first. The runs are removed either way.
+static bool mergeAllExternal(vector<string>& runPaths, const string& tmpDir, size_t blockEdges,
+                             EdgeSinkExternal& sink) {
+    size_t fanIn = mergeFanInExternal();
+    while (runPaths.size() > fanIn) {
+        vector<string> merged;
+        size_t bufferEdges = max<size_t>(1024, blockEdges / (fanIn + 1));
+        for (size_t first = 0; first < runPaths.size(); first += fanIn) {
+            size_t last = min(runPaths.size(), first + fanIn);
+            string mergedPath;
+            FILE* out = createTempExternal(tmpDir, "run", mergedPath);
+            if (out == NULL) {
+                removeExternal(merged);
+                removeExternal(runPaths);
+                return false;
+            }
+            merged.push_back(mergedPath);
+            RunSinkExternal runSink(out, bufferEdges);
+            bool ok = mergeRunsExternal(runPaths, first, last, bufferEdges, runSink) && runSink.flush();
+            ok = closeExternal(out) && ok;
+            if (!ok) {
+                removeExternal(merged);
+                removeExternal(runPaths);
+                return false;
+            }
+        }
+        removeExternal(runPaths);
+        runPaths.swap(merged);
+    }
+
+    size_t bufferEdges = max<size_t>(1024, blockEdges / (runPaths.size() + 1));
+    bool ok = mergeRunsExternal(runPaths, 0, runPaths.size(), bufferEdges, sink);
+    removeExternal(runPaths);
+    runPaths.clear();
+    return ok;
+}
+
+ExternalSorter::ExternalSorter(const string& tmpDir, size_t blockEdges)
+    : tmpDir(tmpDir), blockEdges(max<size_t>(1024, blockEdges)) {
+    block.reserve(this->blockEdges);
+}
+
+ExternalSorter::~ExternalSorter() {
+    removeExternal(runPaths);  // Left over if merge() was never called or failed
+}
+
+// Function to add one edge; a full block is sorted and written as a run
+bool ExternalSorter::add(const ExternalEdge& edge) {
+    block.push_back(edge);
+    return block.size() < blockEdges || writeRun();
+}
+
+// Function to sort the collected block and write it to a new run file
+bool ExternalSorter::writeRun() {
+    sort(block.begin(), block.end());
+    string runPath;
+    FILE* run = createTempExternal(tmpDir, "run", runPath);
+    if (run == NULL) {
+        return false;
+    }
+    runPaths.push_back(runPath);
+    bool ok = writeExternal(block.data(), sizeof(ExternalEdge), block.size(), run);
+    block.clear();
+    return closeExternal(run) && ok;
+}
+
+// Function to hand all added edges to sink in order; the runs are removed afterwards
+bool ExternalSorter::merge(EdgeSinkExternal& sink) {
+    if (runPaths.empty()) {  // Everything fit into one block: sort it in memory
+        sort(block.begin(), block.end());
+        bool ok = true;
+        for (size_t i = 0; ok && i < block.size(); ++i) {
+            ok = sink.edge(block[i]);
+        }
+        vector<ExternalEdge>().swap(block);
+        return ok;
+    }
+    if (!block.empty() && !writeRun()) {
+        return false;
+    }
+    vector<ExternalEdge>().swap(block);  // Give the block memory to the merge buffers
+    return mergeAllExternal(runPaths, tmpDir, blockEdges, sink);
+}
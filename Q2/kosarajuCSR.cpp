@@ -0,0 +1,212 @@
+// kosarajuCSR.cpp
+// This file implements Kosaraju's algorithm for finding strongly connected components (SCCs) in a directed graph
+// using a compressed sparse row (CSR) adjacency. Before the search the vertices can be relabeled (BFS order,
+// Reverse Cuthill-McKee or degree-descending) so that vertices visited together sit close together in memory.
+// The SCCs are printed with the original vertex ids.
+//
+// Usage: ./kosarajuCSR [none|bfs|rcm|degree]
+
+#include "kosaraju_scc.hpp"
+#include "perf_counters.hpp"
+#include <algorithm>
+#include <chrono>
+#include <queue>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+// Function to build a CSR graph from a 0-based edge list
+CSRGraph buildCSR(int n, const vector<pair<int, int>>& edges) {
+    CSRGraph g;
+    g.n = n;
+    g.offsets.assign(n + 1, 0);
+    for (const auto& edge : edges) {  // Count the out-degree of every vertex
+        g.offsets[edge.first + 1]++;
+    }
+    for (int v = 0; v < n; ++v) {  // Prefix sum turns the degrees into row offsets
+        g.offsets[v + 1] += g.offsets[v];
+    }
+    g.targets.resize(edges.size());
+    vector<int> next(g.offsets.begin(), g.offsets.end() - 1);  // Next free slot of every row
+    for (const auto& edge : edges) {  // Scatter the edges into their rows
+        g.targets[next[edge.first]++] = edge.second;
+    }
+    return g;
+}
+
+// Function to get the transposed CSR graph
+CSRGraph getTransposeCSR(const CSRGraph& g) {
+    CSRGraph t;
+    t.n = g.n;
+    vector<pair<int, int>> scratch;  // Edges partitioned by target, see scc::transposeCSR
+    scc::transposeCSR(scc::CSRView<>(g.n, g.offsets.data(), g.targets.data()), t.offsets, t.targets,
+                      max(1u, thread::hardware_concurrency()), scratch);
+    return t;
+}
+
+// Function to compute a vertex relabeling; returns the old id of every new id
+vector<int> computeOrderCSR(const CSRGraph& g, const CSRGraph& transposed, const string& mode) {
+    int n = g.n;
+    vector<int> order;  // order[newId] = oldId
+    order.reserve(n);
+    auto degree = [&](int v) {  // Total degree, counting both edge directions
+        return (g.offsets[v + 1] - g.offsets[v]) + (transposed.offsets[v + 1] - transposed.offsets[v]);
+    };
+
+    if (mode == "degree") {  // Hubs first: the most referenced vertices share the first cache lines
+        for (int v = 0; v < n; ++v) {
+            order.push_back(v);
+        }
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return degree(a) > degree(b); });
+        return order;
+    }
+
+    if (mode == "bfs" || mode == "rcm") {  // Breadth-first over the undirected view of the graph
+        vector<bool> placed(n, false);
+        vector<int> starts;  // Start vertices, one per weakly connected component
+        for (int v = 0; v < n; ++v) {
+            starts.push_back(v);
+        }
+        if (mode == "rcm") {  // Cuthill-McKee starts every component from a low-degree vertex
+            stable_sort(starts.begin(), starts.end(), [&](int a, int b) { return degree(a) < degree(b); });
+        }
+        vector<int> neighbors;
+        for (int start : starts) {
+            if (placed[start]) {
+                continue;
+            }
+            placed[start] = true;
+            size_t head = order.size();
+            order.push_back(start);
+            while (head < order.size()) {
+                int v = order[head++];
+                neighbors.clear();
+                for (int i = g.offsets[v]; i < g.offsets[v + 1]; ++i) {
+                    neighbors.push_back(g.targets[i]);
+                }
+                for (int i = transposed.offsets[v]; i < transposed.offsets[v + 1]; ++i) {
+                    neighbors.push_back(transposed.targets[i]);
+                }
+                if (mode == "rcm") {  // Visit neighbors by increasing degree
+                    stable_sort(neighbors.begin(), neighbors.end(), [&](int a, int b) { return degree(a) < degree(b); });
+                }
+                for (int neighbor : neighbors) {
+                    if (!placed[neighbor]) {
+                        placed[neighbor] = true;
+                        order.push_back(neighbor);
+                    }
+                }
+            }
+        }
+        if (mode == "rcm") {
+            reverse(order.begin(), order.end());  // The "reverse" in Reverse Cuthill-McKee
+        }
+        return order;
+    }
+
+    for (int v = 0; v < n; ++v) {  // "none": keep the ids from the input
+        order.push_back(v);
+    }
+    return order;
+}
+
+// Function to relabel a CSR graph; newId[oldId] gives the new id of every vertex
+CSRGraph permuteCSR(const CSRGraph& g, const vector<int>& order, const vector<int>& newId) {
+    CSRGraph p;
+    p.n = g.n;
+    p.offsets.assign(g.n + 1, 0);
+    p.targets.resize(g.targets.size());
+    for (int v = 0; v < g.n; ++v) {  // Row v of the new graph is row order[v] of the old one
+        int old = order[v];
+        p.offsets[v + 1] = p.offsets[v] + (g.offsets[old + 1] - g.offsets[old]);
+        int out = p.offsets[v];
+        for (int i = g.offsets[old]; i < g.offsets[old + 1]; ++i) {
+            p.targets[out++] = newId[g.targets[i]];
+        }
+        sort(p.targets.begin() + p.offsets[v], p.targets.begin() + out);  // Ascending ids walk memory forward
+    }
+    return p;
+}
+
+// Function to find and print all strongly connected components
+void findSCCsCSR(int n, int m, const vector<pair<int, int>>& edges, const string& orderMode) {
+    typedef chrono::steady_clock Clock;
+    PERF_PHASE("build");
+    vector<pair<int, int>> zeroBased(m);
+    for (int i = 0; i < m; ++i) {
+        zeroBased[i] = make_pair(edges[i].first - 1, edges[i].second - 1);
+    }
+
+    Clock::time_point t0 = Clock::now();
+    CSRGraph adj = buildCSR(n, zeroBased);  // Adjacency in the input numbering
+    vector<int> order;  // order[newId] = oldId, used to map the ids back when printing
+    if (orderMode != "none") {
+        CSRGraph transposed = getTransposeCSR(adj);
+        order = computeOrderCSR(adj, transposed, orderMode);
+        vector<int> newId(n);
+        for (int v = 0; v < n; ++v) {
+            newId[order[v]] = v;
+        }
+        adj = permuteCSR(adj, order, newId);
+    }
+    Clock::time_point t1 = Clock::now();
+
+    scc::SCC<scc::CSRView<>> solver;  // Iterative Kosaraju of the shared SCC library, straight on the CSR arrays
+#ifdef PERF_HARNESS
+    solver.setTransposeThreads(1);  // The comparison table measures every representation single-threaded
+#else
+    solver.setTransposeThreads(max(1u, thread::hardware_concurrency()));
+#endif
+    const scc::Components& sccs = solver.run(scc::CSRView<>(n, adj.offsets.data(), adj.targets.data()), PerfVisitor());
+    Clock::time_point t2 = Clock::now();
+
+    PERF_PHASE("output");
+    cout << "Total number of SCCs: " << sccs.size() << endl;
+    for (int i = 0; i < sccs.size(); ++i) {
+        cout << "SCC " << (i + 1) << " is: ";
+        for (const int* vertex = sccs.begin(i); vertex != sccs.end(i); ++vertex) {
+            cout << ((order.empty() ? *vertex : order[*vertex]) + 1) << " ";  // Map back to the input id
+        }
+        cout << endl;
+    }
+
+    cerr << "order=" << orderMode
+         << " reorder_ms=" << chrono::duration<double, milli>(t1 - t0).count()
+         << " scc_ms=" << chrono::duration<double, milli>(t2 - t1).count() << endl;
+    PERF_REPORT("kosarajuCSR");
+}
+
+int main(int argc, char* argv[]) {
+    string orderMode = argc > 1 ? argv[1] : "none";
+    if (orderMode != "none" && orderMode != "bfs" && orderMode != "rcm" && orderMode != "degree") {
+        cerr << "Usage: " << argv[0] << " [none|bfs|rcm|degree]" << endl;
+        return 1;
+    }
+
+    ifstream infile("graph.txt");  // Open the input file
+    if (!infile) {
+        cerr << "Error opening input file" << endl;
+        return 1;
+    }
+
+    int n, m;
+    infile >> n >> m;  // Read the number of vertices and edges
+    if (n <= 0 || m <= 0) {
+        cerr << "Invalid number of vertices or edges" << endl;
+        return 1;
+    }
+
+    vector<pair<int, int>> edges(m);  // Vector to store all the edges
+    for (int i = 0; i < m; i++) {
+        infile >> edges[i].first >> edges[i].second;  // Read each edge
+        if (edges[i].first <= 0 || edges[i].first > n || edges[i].second <= 0 || edges[i].second > n) {
+            cerr << "Invalid edge: " << edges[i].first << " " << edges[i].second << endl;
+            return 1;
+        }
+    }
+
+    findSCCsCSR(n, m, edges, orderMode);  // Find and print all strongly connected components
+
+    return 0;
+}
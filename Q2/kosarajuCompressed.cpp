@@ -0,0 +1,211 @@
+// kosarajuCompressed.cpp
+// This file implements Kosaraju's algorithm for finding strongly connected components (SCCs) in a directed graph
+// using a compressed adjacency: every neighbor list is sorted and stored as delta gaps encoded as varints
+// (7 bits per byte, high bit set on all but the last byte). The DFS decodes the lists on the fly, so neither
+// the graph nor its transpose is ever materialized uncompressed, and neither is the edge list: it is sorted
+// by the external sort in blocks of bounded size and every row is encoded as the merge reaches it. The
+// program reads a graph from an input file, performs Kosaraju's algorithm, and prints out the SCCs.
+//
+// Usage: ./kosarajuCompressed [sort buffer in MB] [directory for temporary files]
+
+#include "kosaraju_scc.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sys/resource.h>
+
+using namespace std;
+
+// Function to append a varint to the byte stream
+static void putVarint(vector<uint8_t>& bytes, uint32_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));  // Low 7 bits, more bytes follow
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+// Function to encode one sorted neighbor list of vertex v at the end of the graph
+static void appendRowCompressed(CompressedGraph& g, int v, const int* begin, const int* end) {
+    int previous = v;  // The first neighbor is stored relative to v itself
+    bool first = true;
+    for (const int* it = begin; it != end; ++it) {
+        if (first) {  // Zigzag encoding: the first gap may be negative
+            int gap = *it - previous;
+            putVarint(g.bytes, (static_cast<uint32_t>(gap) << 1) ^ static_cast<uint32_t>(gap >> 31));
+            first = false;
+        } else {
+            putVarint(g.bytes, static_cast<uint32_t>(*it - previous));
+        }
+        previous = *it;
+    }
+    g.offsets[v + 1] = g.bytes.size();
+}
+
+// Receiver of the sorted edges that encodes every row as soon as the merge has passed it
+struct CompressedSink : EdgeSinkExternal {
+    CompressedGraph& g;
+    vector<int> row;  // Neighbors of the vertex the merge is at
+    int vertex = 0;
+
+    explicit CompressedSink(CompressedGraph& g) : g(g) {}
+
+    bool edge(const ExternalEdge& edge) {
+        finishRows(edge.from);
+        row.push_back(edge.to);
+        g.edges++;
+        return true;
+    }
+
+    // Function to encode the rows before vertex last, which get no more edges
+    void finishRows(int last) {
+        for (; vertex < last; ++vertex) {
+            appendRowCompressed(g, vertex, row.data(), row.data() + row.size());
+            row.clear();
+        }
+    }
+};
+
+// Function to build a compressed graph from the 0-based edges of a sorter; returns false if the sort failed
+bool buildCompressed(int n, ExternalSorter& sorter, CompressedGraph& g) {
+    g.n = n;
+    g.edges = 0;
+    g.offsets.assign(n + 1, 0);
+    CompressedSink sink(g);
+    if (!sorter.merge(sink)) {  // Rows come out grouped by source, neighbors ascending
+        return false;
+    }
+    sink.finishRows(n);
+    g.bytes.shrink_to_fit();
+    return true;
+}
+
+// Function to get the transposed compressed graph, decoding the forward graph chunk by chunk of at most
+// chunkEdges edges (a chunk of one target vertex may be larger)
+CompressedGraph getTransposeCompressed(const CompressedGraph& g, size_t chunkEdges) {
+    CompressedGraph t;
+    t.n = g.n;
+    t.edges = g.edges;
+    t.offsets.assign(g.n + 1, 0);
+    vector<size_t>& inDegree = t.offsets;  // Borrowed: entry v + 1 is only overwritten once row v is encoded
+    for (int v = 0; v < g.n; ++v) {  // First pass: count the in-degree of every vertex
+        for (NeighborCursor it(g, v); !it.done(); ) {
+            inDegree[it.next() + 1]++;
+        }
+    }
+
+    t.bytes.reserve(g.bytes.size() + g.bytes.size() / 16);  // The same edges take about as many bytes reversed
+    vector<int> buffer;  // Uncompressed rows of the current chunk of target vertices
+    vector<uint32_t> fill, next;  // Row offsets inside the buffer, and where each row is filled up to
+    int lo = 0;
+    while (lo < g.n) {
+        int hi = lo;  // Take target vertices until the chunk holds enough edges
+        size_t edges = 0;
+        while (hi < g.n && (hi == lo || edges + inDegree[hi + 1] <= chunkEdges)) {
+            edges += inDegree[hi + 1];
+            ++hi;
+        }
+        fill.assign(hi - lo + 1, 0);
+        for (int v = lo; v < hi; ++v) {
+            fill[v - lo + 1] = fill[v - lo] + inDegree[v + 1];
+        }
+        buffer.resize(edges);
+        next.assign(fill.begin(), fill.end() - 1);
+        for (int v = 0; v < g.n; ++v) {  // Sources are visited in ascending order, so rows come out sorted
+            for (NeighborCursor it(g, v); !it.done(); ) {
+                int neighbor = it.next();
+                if (neighbor >= lo && neighbor < hi) {
+                    buffer[next[neighbor - lo]++] = v;
+                }
+            }
+        }
+        for (int v = lo; v < hi; ++v) {
+            appendRowCompressed(t, v, buffer.data() + fill[v - lo], buffer.data() + fill[v - lo + 1]);
+        }
+        lo = hi;
+    }
+    if (t.bytes.capacity() - t.bytes.size() > t.bytes.size() / 8) {  // Shrinking copies, only worth it if the guess was far off
+        t.bytes.shrink_to_fit();
+    }
+    return t;
+}
+
+// Function to find and print all strongly connected components; the buffers of the build use chunkEdges edges
+bool findSCCsCompressed(int n, int m, ExternalSorter& sorter, size_t chunkEdges) {
+    typedef chrono::steady_clock Clock;
+    Clock::time_point t0 = Clock::now();
+    CompressedGraph adj;
+    if (!buildCompressed(n, sorter, adj)) {
+        return false;
+    }
+    CompressedGraph transposedAdj = getTransposeCompressed(adj, chunkEdges);  // Get the transposed graph
+    Clock::time_point t1 = Clock::now();
+
+    scc::SCC<CompressedGraph> solver;  // Iterative Kosaraju of the shared SCC library, decoding the lists on the fly
+    const scc::Components& sccs = solver.runWithTranspose(adj, transposedAdj, scc::NoVisitor());  // Compressed transpose
+    Clock::time_point t2 = Clock::now();
+
+    cout << "Total number of SCCs: " << sccs.size() << endl;
+    for (int i = 0; i < sccs.size(); ++i) {
+        cout << "SCC " << (i + 1) << " is: ";
+        for (const int* vertex = sccs.begin(i); vertex != sccs.end(i); ++vertex) {
+            cout << (*vertex + 1) << " ";
+        }
+        cout << endl;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double edgesCount = m > 0 ? m : 1;
+    cerr << "adjacency_bytes_per_edge=" << adj.bytes.size() / edgesCount
+         << " transpose_bytes_per_edge=" << transposedAdj.bytes.size() / edgesCount
+         << " build_ms=" << chrono::duration<double, milli>(t1 - t0).count()
+         << " scc_ms=" << chrono::duration<double, milli>(t2 - t1).count()
+         << " peak_rss_mb=" << usage.ru_maxrss / 1024.0 << endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    size_t bufferMB = argc > 1 ? strtoul(argv[1], NULL, 10) : 16;
+    string tmpDir = argc > 2 ? argv[2] : ".";
+    if (bufferMB == 0) {
+        cerr << "Usage: " << argv[0] << " [sort buffer in MB] [directory for temporary files]" << endl;
+        return 1;
+    }
+
+    ifstream infile("graph.txt");  // Open the input file
+    if (!infile) {
+        cerr << "Error opening input file" << endl;
+        return 1;
+    }
+
+    int n, m;
+    infile >> n >> m;  // Read the number of vertices and edges
+    if (n <= 0 || m <= 0) {
+        cerr << "Invalid number of vertices or edges" << endl;
+        return 1;
+    }
+
+    // The edges go straight into the sorter, no uncompressed edge list is kept
+    size_t blockEdges = (bufferMB << 20) / sizeof(ExternalEdge);
+    ExternalSorter sorter(tmpDir, blockEdges);
+    for (int i = 0; i < m; i++) {
+        int u, v;
+        infile >> u >> v;  // Read each edge
+        if (u <= 0 || u > n || v <= 0 || v > n) {
+            cerr << "Invalid edge: " << u << " " << v << endl;
+            return 1;
+        }
+        ExternalEdge edge = {static_cast<uint32_t>(u - 1), static_cast<uint32_t>(v - 1)};  // Switch to 0-based ids
+        if (!sorter.add(edge)) {
+            return 1;
+        }
+    }
+
+    // Find and print all strongly connected components; the transpose chunks reuse the sort buffer size
+    if (!findSCCsCompressed(n, m, sorter, (bufferMB << 20) / sizeof(int))) {
+        return 1;
+    }
+
+    return 0;
+}
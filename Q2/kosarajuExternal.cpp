@@ -0,0 +1,253 @@
+// kosarajuExternal.cpp
+// This file implements Kosaraju's algorithm for finding strongly connected components (SCCs) in directed graphs
+// that are larger than RAM. The edge list is streamed from the input file into a binary file, sorted on disk
+// (sorted runs of bounded size followed by a k-way merge) once by source and once by target, and the two
+// sorted files become the targets of an on-disk CSR graph and its transpose. Both are memory-mapped, so only
+// the O(V) arrays (row offsets, visited flags, finishing order, DFS stack) live in RAM: a semi-external search.
+//
+// Usage: ./kosarajuExternal [graph file] [memory budget in MB] [directory for temporary files]
+
+#include "kosaraju_scc.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Function to stream the text edge list into a binary edge file in tmpDir; returns false on invalid input
+bool convertEdgesExternal(const string& textPath, const string& tmpDir, string& binPath, int& n, long long& m) {
+    ifstream infile(textPath.c_str());  // Open the input file
+    if (!infile) {
+        cerr << "Error opening input file" << endl;
+        return false;
+    }
+    infile >> n >> m;  // Read the number of vertices and edges
+    if (n <= 0 || m <= 0) {
+        cerr << "Invalid number of vertices or edges" << endl;
+        return false;
+    }
+
+    FILE* out = createTempExternal(tmpDir, "edges", binPath);
+    if (out == NULL) {
+        return false;
+    }
+    vector<ExternalEdge> buffer;
+    buffer.reserve(1 << 16);
+    bool ok = true;
+    for (long long i = 0; ok && i < m; i++) {
+        long long u, v;
+        infile >> u >> v;  // Read each edge
+        if (u <= 0 || u > n || v <= 0 || v > n) {
+            cerr << "Invalid edge: " << u << " " << v << endl;
+            ok = false;
+            break;
+        }
+        ExternalEdge edge = {static_cast<uint32_t>(u - 1), static_cast<uint32_t>(v - 1)};
+        buffer.push_back(edge);
+        if (buffer.size() == buffer.capacity()) {
+            ok = writeExternal(buffer.data(), sizeof(ExternalEdge), buffer.size(), out);
+            buffer.clear();
+        }
+    }
+    ok = ok && writeExternal(buffer.data(), sizeof(ExternalEdge), buffer.size(), out);
+    ok = closeExternal(out) && ok;
+    if (!ok) {
+        unlink(binPath.c_str());
+    }
+    return ok;
+}
+
+// Receiver of the last merge pass of sortEdgesExternal: writes the targets, counts the row lengths
+struct TargetsSinkExternal : EdgeSinkExternal {
+    FILE* file;
+    vector<uint64_t>& offsets;
+    vector<uint32_t> buffer;
+
+    TargetsSinkExternal(FILE* file, vector<uint64_t>& offsets, size_t bufferEdges) : file(file), offsets(offsets) {
+        buffer.reserve(bufferEdges);
+    }
+
+    bool edge(const ExternalEdge& edge) {
+        offsets[edge.from + 1]++;  // Count the row length
+        buffer.push_back(edge.to);
+        return buffer.size() < buffer.capacity() || flush();
+    }
+
+    bool flush() {
+        bool written = writeExternal(buffer.data(), sizeof(uint32_t), buffer.size(), file);
+        buffer.clear();
+        return written;
+    }
+};
+
+// Function to sort the binary edge file on disk and write the CSR targets to a new file in tmpDir.
+// With byTarget set every edge is reversed first, which produces the transposed graph.
+bool sortEdgesExternal(const string& binPath, const string& tmpDir, bool byTarget, size_t blockEdges, int n,
+                       string& targetsPath, vector<uint64_t>& offsets) {
+    FILE* in = fopen(binPath.c_str(), "rb");
+    if (in == NULL) {
+        perror("fopen");
+        return false;
+    }
+
+    // Phase 1: cut the edge file into sorted runs that fit into the memory budget
+    ExternalSorter sorter(tmpDir, blockEdges);
+    vector<ExternalEdge> buffer(1 << 12);
+    size_t count;
+    bool ok = true;
+    while (ok && (count = fread(buffer.data(), sizeof(ExternalEdge), buffer.size(), in)) > 0) {
+        for (size_t i = 0; ok && i < count; ++i) {
+            if (byTarget) {
+                swap(buffer[i].from, buffer[i].to);
+            }
+            ok = sorter.add(buffer[i]);
+        }
+    }
+    if (ok && ferror(in)) {
+        cerr << "Error reading " << binPath << endl;
+        ok = false;
+    }
+    fclose(in);
+    if (!ok) {
+        return false;
+    }
+
+    // Phase 2: k-way merge of the runs; only the targets are written, the sources become row offsets
+    FILE* out = createTempExternal(tmpDir, byTarget ? "transpose" : "forward", targetsPath);
+    if (out == NULL) {
+        return false;
+    }
+    offsets.assign(n + 1, 0);
+    TargetsSinkExternal sink(out, offsets, 1 << 16);
+    ok = sorter.merge(sink) && sink.flush();
+    ok = closeExternal(out) && ok;
+    if (!ok) {
+        unlink(targetsPath.c_str());
+        return false;
+    }
+    for (int v = 0; v < n; ++v) {  // Prefix sum turns the row lengths into offsets
+        offsets[v + 1] += offsets[v];
+    }
+    return true;
+}
+
+// Function to memory-map a CSR targets file; returns NULL on failure
+const uint32_t* mapTargetsExternal(const string& path, size_t& length) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        perror("open");
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("fstat");
+        close(fd);
+        return NULL;
+    }
+    length = st.st_size;
+    if (length == 0) {
+        close(fd);
+        return NULL;
+    }
+    void* data = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // The mapping stays valid after closing the descriptor
+    if (data == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+    return static_cast<const uint32_t*>(data);
+}
+
+// SCC library visitor: releases the forward edges after the first pass and prints every component as it is
+// found instead of collecting the output in RAM
+struct ExternalVisitor : scc::NoVisitor {
+    const uint32_t* targets;
+    size_t forwardLength;
+    int sccCount = 0;
+
+    ExternalVisitor(const uint32_t* targets, size_t forwardLength) : targets(targets), forwardLength(forwardLength) {}
+
+    void phase(scc::Phase phase) {
+        if (phase == scc::SECOND_PASS) {  // The forward edges are done
+            madvise(const_cast<uint32_t*>(targets), forwardLength, MADV_DONTNEED);
+        }
+    }
+
+    void component(const int* first, const int* last) {
+        cout << "SCC " << ++sccCount << " is: ";
+        for (const int* vertex = first; vertex != last; ++vertex) {
+            cout << (*vertex + 1) << " ";
+        }
+        cout << "\n";
+    }
+};
+
+// Function to find and print all strongly connected components of a graph kept on disk
+bool findSCCsExternal(const string& graphPath, size_t memoryBytes, const string& tmpDir) {
+    int n;
+    long long m;
+    string edgesPath, forwardPath, transposePath;  // Temporary files, named uniquely by createTempExternal
+    if (!convertEdgesExternal(graphPath, tmpDir, edgesPath, n, m)) {
+        return false;
+    }
+
+    size_t blockEdges = max<size_t>(1024, memoryBytes / sizeof(ExternalEdge));
+    vector<uint64_t> offsets, transposedOffsets;  // The only per-vertex graph data kept in RAM
+    bool forwardSorted = sortEdgesExternal(edgesPath, tmpDir, false, blockEdges, n, forwardPath, offsets);
+    bool sorted = forwardSorted &&
+                  sortEdgesExternal(edgesPath, tmpDir, true, blockEdges, n, transposePath, transposedOffsets);
+    unlink(edgesPath.c_str());
+    if (!sorted) {
+        if (forwardSorted) {
+            unlink(forwardPath.c_str());
+        }
+        return false;
+    }
+
+    size_t forwardLength, transposeLength;
+    const uint32_t* targets = mapTargetsExternal(forwardPath, forwardLength);
+    const uint32_t* transposedTargets = mapTargetsExternal(transposePath, transposeLength);
+    unlink(forwardPath.c_str());  // The mappings keep the data alive until they are removed
+    unlink(transposePath.c_str());
+    if (targets == NULL || transposedTargets == NULL) {
+        if (targets != NULL) {  // Only one of the two files could be mapped
+            munmap(const_cast<uint32_t*>(targets), forwardLength);
+        }
+        if (transposedTargets != NULL) {
+            munmap(const_cast<uint32_t*>(transposedTargets), transposeLength);
+        }
+        return false;
+    }
+
+    typedef scc::CSRView<uint64_t, uint32_t> MappedGraph;  // Offsets in RAM, targets in the mapped files
+    scc::SCC<MappedGraph> solver;  // Iterative Kosaraju of the shared SCC library
+    ExternalVisitor visitor(targets, forwardLength);
+    solver.runWithTranspose(MappedGraph(n, offsets.data(), targets),
+                            MappedGraph(n, transposedOffsets.data(), transposedTargets), visitor);
+    cout << "Total number of SCCs: " << visitor.sccCount << endl;
+
+    munmap(const_cast<uint32_t*>(targets), forwardLength);
+    munmap(const_cast<uint32_t*>(transposedTargets), transposeLength);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    string graphPath = argc > 1 ? argv[1] : "graph.txt";
+    size_t memoryMB = argc > 2 ? strtoul(argv[2], NULL, 10) : 256;
+    string tmpDir = argc > 3 ? argv[3] : ".";
+    if (memoryMB == 0) {
+        cerr << "Usage: " << argv[0] << " [graph file] [memory budget in MB] [directory for temporary files]" << endl;
+        return 1;
+    }
+
+    if (!findSCCsExternal(graphPath, memoryMB << 20, tmpDir)) {  // Find and print all strongly connected components
+        return 1;
+    }
+
+    return 0;
+}
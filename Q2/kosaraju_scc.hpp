@@ -3,35 +3,158 @@
 
 #include <iostream>
 #include <vector>
-#include <stack>
 #include <list>
 #include <deque>
 #include <fstream>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include "../scc/scc.hpp"
 
 using namespace std;
 
 // Declarations for List Implementation (std::list)
-void fillOrderList(int v, vector<bool>& visited, stack<int>& Stack, const list<list<int>>& adj);
-void DFSUtilList(int v, vector<bool>& visited, const list<list<int>>& transposedAdj, vector<int>& component);
-list<list<int>> getTransposeList(int n, const list<list<int>>& adj);
 void findSCCsList(int n, int m, const vector<pair<int, int>>& edges);
 
 // Declarations for Deque Implementation (std::deque)
-void fillOrderDeque(int v, vector<bool>& visited, stack<int>& Stack, const vector<deque<int>>& adj);
-void DFSUtilDeque(int v, vector<bool>& visited, const vector<deque<int>>& transposedAdj, vector<int>& component);
-vector<deque<int>> getTransposeDeque(int n, const vector<deque<int>>& adj);
 void findSCCsDeque(int n, int m, const vector<pair<int, int>>& edges);
 
 // Declarations for Vector of Vectors Implementation
-void fillOrderVectorVec(int v, vector<bool>& visited, stack<int>& Stack, const vector<vector<int>>& adj);
-void DFSUtilVectorVec(int v, vector<bool>& visited, const vector<vector<int>>& transposedAdj, vector<int>& component);
-vector<vector<int>> getTransposeVectorVec(const vector<vector<int>>& adj);
 void findSCCsVectorVec(int n, int m, const vector<pair<int, int>>& edges);
 
 // Declarations for Vector of Lists Implementation
-void fillOrderVectorList(int v, vector<bool>& visited, stack<int>& Stack, const vector<list<int>>& adj);
-void DFSUtilVectorList(int v, vector<bool>& visited, const vector<list<int>>& transposedAdj, vector<int>& component);
-vector<list<int>> getTransposeVectorList(const vector<list<int>>& adj);
 void findSCCsVectorList(int n, int m, const vector<pair<int, int>>& edges);
 
+// Compressed sparse row graph: the neighbors of v are targets[offsets[v]] .. targets[offsets[v + 1] - 1]
+struct CSRGraph {
+    int n;
+    vector<int> offsets;
+    vector<int> targets;
+};
+
+// Declarations for CSR Implementation (with optional vertex reordering)
+CSRGraph buildCSR(int n, const vector<pair<int, int>>& edges);
+CSRGraph getTransposeCSR(const CSRGraph& g);
+vector<int> computeOrderCSR(const CSRGraph& g, const CSRGraph& transposed, const string& mode);
+CSRGraph permuteCSR(const CSRGraph& g, const vector<int>& order, const vector<int>& newId);
+void findSCCsCSR(int n, int m, const vector<pair<int, int>>& edges, const string& orderMode);
+
+// Compressed adjacency: the sorted neighbors of v are varint-encoded gaps in bytes[offsets[v]] .. bytes[offsets[v + 1] - 1].
+// The first gap is taken from v itself and zigzag-encoded, the following ones from the previous neighbor.
+struct CompressedGraph {
+    int n;
+    size_t edges;
+    vector<size_t> offsets;
+    vector<uint8_t> bytes;
+};
+
+// Cursor that decodes the neighbor list of one vertex on the fly
+struct NeighborCursor {
+    int vertex;
+    const uint8_t* pos;
+    const uint8_t* end;
+    int previous;
+    bool first;
+
+    NeighborCursor(const CompressedGraph& g, int v)
+        : vertex(v), pos(g.bytes.data() + g.offsets[v]), end(g.bytes.data() + g.offsets[v + 1]), previous(v), first(true) {}
+
+    bool done() const { return pos == end; }
+
+    int next() {
+        uint32_t value = *pos & 0x7f;  // Decode one varint
+        for (int shift = 7; *pos++ & 0x80; shift += 7) {
+            value |= static_cast<uint32_t>(*pos & 0x7f) << shift;
+        }
+        if (first) {  // Undo the zigzag encoding of the first gap
+            first = false;
+            previous += static_cast<int>((value >> 1) ^ (0u - (value & 1)));
+        } else {
+            previous += static_cast<int>(value);
+        }
+        return previous;
+    }
+};
+
+// Neighbor iterator of the SCC library over a compressed list; holds the decoded neighbor it points at
+struct CompressedNeighborIterator {
+    NeighborCursor cursor;
+    int current;
+    bool atEnd;
+
+    CompressedNeighborIterator(const CompressedGraph& g, int v, bool atEnd) : cursor(g, v), current(v), atEnd(atEnd) {
+        if (!atEnd) {
+            ++*this;  // Decode the first neighbor
+        }
+    }
+
+    int operator*() const { return current; }
+
+    CompressedNeighborIterator& operator++() {
+        atEnd = cursor.done();
+        if (!atEnd) {
+            current = cursor.next();
+        }
+        return *this;
+    }
+
+    bool operator!=(const CompressedNeighborIterator& other) const { return atEnd != other.atEnd; }  // Same list only
+};
+
+namespace scc {
+template <>
+struct GraphTraits<CompressedGraph> {
+    typedef CompressedNeighborIterator Iterator;
+    static int vertexCount(const CompressedGraph& g) { return g.n; }
+    static Iterator begin(const CompressedGraph& g, int v) { return Iterator(g, v, false); }
+    static Iterator end(const CompressedGraph& g, int v) { return Iterator(g, v, true); }
+};
+}
+
+// One edge of the external sort and of the binary edge file (0-based vertices)
+struct ExternalEdge {
+    uint32_t from;
+    uint32_t to;
+};
+
+// Receiver of the edges of an external sort, in order by source, then by target; returns false on failure
+struct EdgeSinkExternal {
+    virtual ~EdgeSinkExternal() {}
+    virtual bool edge(const ExternalEdge& edge) = 0;
+};
+
+// Sort of more edges than fit into RAM: add() collects blockEdges edges at a time, sorts them and writes them
+// to a run file in tmpDir; merge() hands all edges to a sink in order and removes the runs
+class ExternalSorter {
+public:
+    ExternalSorter(const string& tmpDir, size_t blockEdges);
+    ~ExternalSorter();
+    bool add(const ExternalEdge& edge);
+    bool merge(EdgeSinkExternal& sink);
+
+private:
+    bool writeRun();
+    string tmpDir;
+    size_t blockEdges;
+    vector<ExternalEdge> block;  // Edges not in a run yet
+    vector<string> runPaths;
+};
+
+// Declarations for the temporary files of the external sort (external_sort.cpp)
+FILE* createTempExternal(const string& tmpDir, const string& name, string& path);
+bool writeExternal(const void* data, size_t size, size_t count, FILE* file);
+bool closeExternal(FILE* file);
+
+// Declarations for Compressed Adjacency Implementation
+bool buildCompressed(int n, ExternalSorter& sorter, CompressedGraph& g);
+CompressedGraph getTransposeCompressed(const CompressedGraph& g, size_t chunkEdges);
+bool findSCCsCompressed(int n, int m, ExternalSorter& sorter, size_t chunkEdges);
+
+// Declarations for External-Memory Implementation (edges sorted on disk and memory-mapped, O(V) RAM)
+bool convertEdgesExternal(const string& textPath, const string& tmpDir, string& binPath, int& n, long long& m);
+bool sortEdgesExternal(const string& binPath, const string& tmpDir, bool byTarget, size_t blockEdges, int n,
+                       string& targetsPath, vector<uint64_t>& offsets);
+const uint32_t* mapTargetsExternal(const string& path, size_t& length);
+bool findSCCsExternal(const string& graphPath, size_t memoryBytes, const string& tmpDir);
+
 #endif // KOSARAJU_SCC_H
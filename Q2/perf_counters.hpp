@@ -0,0 +1,207 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+// Hardware counters of the SCC phases (cycles, instructions, LLC misses, branch misses), read with
+// perf_event_open around each phase. Compiled in with -DPERF_HARNESS, which "make perf_compare" builds
+// at -O2 and -O3 without -pg; otherwise PERF_PHASE and PERF_REPORT expand to nothing.
+//
+// PERF_PHASE("name") ends the running phase and starts the next one, so the phases follow the code
+// without extra scopes. PERF_REPORT("program") ends the last phase and prints the table to stderr.
+// Counters the kernel refuses (no PMU in a VM, perf_event_paranoid) are shown as n/a; the times remain.
+// PerfVisitor gives the stages inside the SCC library their own phases.
+
+#include "../scc/scc.hpp"
+
+#ifdef PERF_HARNESS
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifndef PERF_LABEL
+#define PERF_LABEL ""  // Optimization level shown in the table, set by the Makefile
+#endif
+
+enum PerfEvent { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_LLC_MISSES, PERF_BRANCH_MISSES, PERF_EVENTS };
+
+// Counter values and wall time of one phase
+struct PerfPhaseResult {
+    const char* name;
+    uint64_t values[PERF_EVENTS];
+    double ms;
+};
+
+// One counter per event, opened once for the calling thread and reset for every phase
+class PerfCounters {
+public:
+    PerfCounters() {
+        fds[PERF_CYCLES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds[PERF_INSTRUCTIONS] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds[PERF_LLC_MISSES] = openCounter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL |
+                                                                   (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        if (fds[PERF_LLC_MISSES] < 0) {  // Some CPUs only have the generic last-level miss event
+            fds[PERF_LLC_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        }
+        fds[PERF_BRANCH_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    }
+
+    ~PerfCounters() {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available(int event) const { return fds[event] >= 0; }
+
+    void start(const char* name) {
+        current.name = name;
+        for (int fd : fds) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+        started = std::chrono::steady_clock::now();
+        running = true;
+    }
+
+    void stop() {
+        if (!running) {
+            return;
+        }
+        std::chrono::steady_clock::time_point stopped = std::chrono::steady_clock::now();
+        for (int event = 0; event < PERF_EVENTS; ++event) {
+            if (fds[event] >= 0) {
+                ioctl(fds[event], PERF_EVENT_IOC_DISABLE, 0);
+            }
+            current.values[event] = readCounter(fds[event]);
+        }
+        current.ms = std::chrono::duration<double, std::milli>(stopped - started).count();
+        phases.push_back(current);
+        running = false;
+    }
+
+    std::vector<PerfPhaseResult> phases;  // Finished phases in order
+
+private:
+    int fds[PERF_EVENTS];
+    PerfPhaseResult current;
+    std::chrono::steady_clock::time_point started;
+    bool running = false;
+
+    static int openCounter(uint32_t type, uint64_t config) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;  // User-space work of the representation only
+        attr.exclude_hv = 1;
+        attr.inherit = 1;  // Threads started during a phase count too
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));  // This thread and its new threads, any CPU
+    }
+
+    // Reads a counter, scaled up if the kernel multiplexed it with other events
+    static uint64_t readCounter(int fd) {
+        uint64_t data[3] = {0, 0, 0};  // value, time enabled, time running
+        if (fd < 0 || read(fd, data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+            return 0;
+        }
+        if (data[2] > 0 && data[2] < data[1]) {
+            return static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]);
+        }
+        return data[0];
+    }
+};
+
+// Counters shared by the phases of the program
+inline PerfCounters& perfCounters() {
+    static PerfCounters counters;
+    return counters;
+}
+
+// Function to end the running phase and start the next one
+inline void perfPhase(const char* name) {
+    PerfCounters& counters = perfCounters();
+    counters.stop();
+    counters.start(name);
+}
+
+// Function to print one counter column, n/a where the counter could not be opened
+inline void printPerfValue(const PerfCounters& counters, int event, uint64_t value, int width) {
+    if (counters.available(event)) {
+        fprintf(stderr, " %*llu", width, static_cast<unsigned long long>(value));
+    } else {
+        fprintf(stderr, " %*s", width, "n/a");
+    }
+}
+
+// Function to print one row of the table
+inline void printPerfRow(const PerfCounters& counters, const PerfPhaseResult& phase) {
+    fprintf(stderr, "  %-12s", phase.name);
+    printPerfValue(counters, PERF_CYCLES, phase.values[PERF_CYCLES], 14);
+    printPerfValue(counters, PERF_INSTRUCTIONS, phase.values[PERF_INSTRUCTIONS], 14);
+    if (counters.available(PERF_CYCLES) && counters.available(PERF_INSTRUCTIONS) && phase.values[PERF_CYCLES] > 0) {
+        fprintf(stderr, " %6.2f", static_cast<double>(phase.values[PERF_INSTRUCTIONS]) / phase.values[PERF_CYCLES]);
+    } else {
+        fprintf(stderr, " %6s", "n/a");
+    }
+    printPerfValue(counters, PERF_LLC_MISSES, phase.values[PERF_LLC_MISSES], 12);
+    printPerfValue(counters, PERF_BRANCH_MISSES, phase.values[PERF_BRANCH_MISSES], 14);
+    fprintf(stderr, " %10.2f\n", phase.ms);
+}
+
+// Function to end the last phase and print the table of all phases with their total
+inline void perfReport(const char* program) {
+    PerfCounters& counters = perfCounters();
+    counters.stop();
+    fprintf(stderr, "%s %s\n", program, PERF_LABEL);
+    fprintf(stderr, "  %-12s %14s %14s %6s %12s %14s %10s\n", "phase", "cycles", "instructions", "IPC", "LLC misses",
+            "branch misses", "ms");
+    PerfPhaseResult total;
+    memset(&total, 0, sizeof(total));
+    total.name = "total";
+    for (const PerfPhaseResult& phase : counters.phases) {
+        printPerfRow(counters, phase);
+        for (int event = 0; event < PERF_EVENTS; ++event) {
+            total.values[event] += phase.values[event];
+        }
+        total.ms += phase.ms;
+    }
+    printPerfRow(counters, total);
+}
+
+#define PERF_PHASE(name) perfPhase(name)
+#define PERF_REPORT(program) perfReport(program)
+
+#else
+
+#define PERF_PHASE(name) do {} while (0)
+#define PERF_REPORT(program) do {} while (0)
+
+#endif // PERF_HARNESS
+
+// SCC library visitor that starts a phase at every stage of the search
+struct PerfVisitor : scc::NoVisitor {
+    void phase(scc::Phase phase) {
+        if (phase != scc::DONE) {  // The caller starts its own phase after the search
+            PERF_PHASE(scc::phaseName(phase));
+        }
+    }
+};
+
+#endif // PERF_COUNTERS_H
@@ -1,4 +1,5 @@
 import random
+import sys
 
 # Function to generate a random graph and save it to a file
 def generate_graph_file(num_vertices, num_edges, filename):
@@ -15,9 +16,12 @@ def generate_graph_file(num_vertices, num_edges, filename):
         for edge in edges:
             f.write(f"{edge[0]} {edge[1]}\n")  # Write each edge to the file
 
-# Parameters for the graph generation
+# Parameters for the graph generation (optionally overridden: python3 randomGraph.py <vertices> <edges>)
 num_vertices = 10000  # Change this to the desired number of vertices
 num_edges = 10000    # Change this to the desired number of edges
+if len(sys.argv) == 3:
+    num_vertices = int(sys.argv[1])
+    num_edges = int(sys.argv[2])
 filename = "graph.txt"  # The name of the file to save the graph
 
 # Generate the graph and save it to a file
@@ -4,16 +4,16 @@
 
 #include <iostream>
 #include <vector>
-#include <stack>
 #include <list>
 #include <sstream>
+#include "../scc/scc.hpp"
 
 using namespace std;
 
 // Class to manage the graph and its operations
 class Graph {
 public:
-    Graph(int n) : adj(n), n(n) {}  // Constructor to initialize the graph with n vertices
+    Graph(int n) : adj(n) {}  // Constructor to initialize the graph with n vertices
 
     // Method to add an edge from u to v
     void addEdge(int u, int v) {
@@ -27,41 +27,14 @@ public:
 
     // Method to compute and print all SCCs using Kosaraju's algorithm
     void kosaraju() {
-        vector<vector<int>> sccs;  // Vector to store all SCCs
-        vector<bool> visited(n, false);  // Visited array to keep track of visited vertices
-        stack<int> Stack;  // Stack to store the order of vertices by finishing times
-
-        // Perform DFS for each vertex to fill the stack
-        for (int i = 0; i < n; ++i) {
-            if (!visited[i]) {
-                fillOrder(i, visited, Stack);
-            }
-        }
-
-        list<int>* transposedAdj = getTranspose();  // Get the transposed graph
-
-        fill(visited.begin(), visited.end(), false);  // Mark all vertices as not visited for the second DFS
-
-        // Process all vertices in the order defined by the stack
-        while (!Stack.empty()) {
-            int v = Stack.top();
-            Stack.pop();
-
-            if (!visited[v]) {
-                vector<int> component;  // Vector to store the current SCC
-                DFSUtil(v, visited, transposedAdj, component);  // Perform DFS on the transposed graph
-                sccs.push_back(component);
-            }
-        }
-
-        delete[] transposedAdj;  // Free the memory used by the transposed graph
+        const scc::Components& sccs = solver.run(adj);  // Iterative Kosaraju of the shared SCC library
 
         // Print the SCCs
         cout << "Total number of SCCs: " << sccs.size() << endl;
         for (int i = 0; i < sccs.size(); ++i) {
             cout << "SCC " << (i + 1) << " is: ";
-            for (int vertex : sccs[i]) {
-                cout << (vertex + 1) << " ";
+            for (const int* vertex = sccs.begin(i); vertex != sccs.end(i); ++vertex) {
+                cout << (*vertex + 1) << " ";
             }
             cout << endl;
         }
@@ -69,40 +42,7 @@ public:
 
 private:
     vector<list<int>> adj;  // Adjacency list representation of the graph
-    int n;  // Number of vertices in the graph
-
-    // Helper method to perform DFS and fill the stack
-    void fillOrder(int v, vector<bool>& visited, stack<int>& Stack) {
-        visited[v] = true;  // Mark the current node as visited
-        for (int neighbor : adj[v]) {  // Iterate over all the adjacent vertices
-            if (!visited[neighbor]) {  // If the adjacent vertex has not been visited
-                fillOrder(neighbor, visited, Stack);  // Recursive call for the adjacent vertex
-            }
-        }
-        Stack.push(v);  // Push the vertex to the stack after all its adjacent vertices are processed
-    }
-
-    // Helper method to perform DFS on the transposed graph
-    void DFSUtil(int v, vector<bool>& visited, list<int>* transposedAdj, vector<int>& component) {
-        visited[v] = true;  // Mark the current node as visited
-        component.push_back(v);  // Add this vertex to the current component
-        for (int neighbor : transposedAdj[v]) {  // Iterate over all the adjacent vertices in the transposed graph
-            if (!visited[neighbor]) {  // If the adjacent vertex has not been visited
-                DFSUtil(neighbor, visited, transposedAdj, component);  // Recursive call for the adjacent vertex
-            }
-        }
-    }
-
-    // Helper method to get the transposed graph
-    list<int>* getTranspose() {
-        list<int>* transposedAdj = new list<int>[n];  // Create an empty transposed graph
-        for (int v = 0; v < n; ++v) {  // Iterate over each vertex
-            for (int neighbor : adj[v]) {  // Iterate over all the adjacent vertices
-                transposedAdj[neighbor].push_back(v);  // Add an edge from neighbor to v in the transposed graph
-            }
-        }
-        return transposedAdj;  // Return the transposed graph
-    }
+    scc::SCC<vector<list<int>>> solver;  // Keeps its buffers between queries
 };
 
 // Function to handle the "Newgraph" command
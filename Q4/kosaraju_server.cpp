@@ -1,6 +1,5 @@
 #include <iostream>
 #include <vector>
-#include <stack>
 #include <list>
 #include <sstream>
 #include <string>
@@ -13,15 +12,23 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <sys/select.h>
+#include <map>
+#include <cerrno>
+#include <fcntl.h>
+#include "../scc/scc.hpp"
 
 using namespace std;
 
 #define PORT "9034"   // the port users will be connecting to
 
+size_t highWaterMark = 1024 * 1024;  // stop reading a client once this much output is pending
+size_t lowWaterMark = 256 * 1024;    // resume reading once its pending output drained to this
+const size_t MAX_LINE = 64 * 1024;   // longest command line accepted
+
 // Class to manage the graph and its operations
 class Graph {
 public:
-    Graph(int n) : adj(n), n(n) {}  // Constructor to initialize the graph with n vertices
+    Graph(int n) : adj(n) {}  // Constructor to initialize the graph with n vertices
 
     // Method to add an edge from u to v
     void addEdge(int u, int v) {
@@ -35,42 +42,15 @@ public:
 
     // Method to compute and return all SCCs using Kosaraju's algorithm
     string kosaraju() {
-        vector<vector<int>> sccs;  // Vector to store all SCCs
-        vector<bool> visited(n, false);  // Visited array to keep track of visited vertices
-        stack<int> Stack;  // Stack to store the order of vertices by finishing times
-
-        // Perform DFS for each vertex to fill the stack
-        for (int i = 0; i < n; ++i) {
-            if (!visited[i]) {
-                fillOrder(i, visited, Stack);
-            }
-        }
-
-        list<int>* transposedAdj = getTranspose();  // Get the transposed graph
-
-        fill(visited.begin(), visited.end(), false);  // Mark all vertices as not visited for the second DFS
-
-        // Process all vertices in the order defined by the stack
-        while (!Stack.empty()) {
-            int v = Stack.top();
-            Stack.pop();
-
-            if (!visited[v]) {
-                vector<int> component;  // Vector to store the current SCC
-                DFSUtil(v, visited, transposedAdj, component);  // Perform DFS on the transposed graph
-                sccs.push_back(component);
-            }
-        }
-
-        delete[] transposedAdj;  // Free the memory used by the transposed graph
+        const scc::Components& sccs = solver.run(adj);  // Iterative Kosaraju of the shared SCC library
 
         // Prepare the SCCs result string
         stringstream ss;
         ss << "Total number of SCCs: " << sccs.size() << endl;
         for (int i = 0; i < sccs.size(); ++i) {
             ss << "SCC " << (i + 1) << " is: ";
-            for (int vertex : sccs[i]) {
-                ss << (vertex + 1) << " ";
+            for (const int* vertex = sccs.begin(i); vertex != sccs.end(i); ++vertex) {
+                ss << (*vertex + 1) << " ";
             }
             ss << endl;
         }
@@ -79,83 +59,163 @@ public:
 
 private:
     vector<list<int>> adj;  // Adjacency list representation of the graph
-    int n;  // Number of vertices in the graph
-
-    // Helper method to perform DFS and fill the stack
-    void fillOrder(int v, vector<bool>& visited, stack<int>& Stack) {
-        visited[v] = true;  // Mark the current node as visited
-        for (int neighbor : adj[v]) {  // Iterate over all the adjacent vertices
-            if (!visited[neighbor]) {  // If the adjacent vertex has not been visited
-                fillOrder(neighbor, visited, Stack);  // Recursive call for the adjacent vertex
-            }
-        }
-        Stack.push(v);  // Push the vertex to the stack after all its adjacent vertices are processed
-    }
-
-    // Helper method to perform DFS on the transposed graph
-    void DFSUtil(int v, vector<bool>& visited, list<int>* transposedAdj, vector<int>& component) {
-        visited[v] = true;  // Mark the current node as visited
-        component.push_back(v);  // Add this vertex to the current component
-        for (int neighbor : transposedAdj[v]) {  // Iterate over all the adjacent vertices in the transposed graph
-            if (!visited[neighbor]) {  // If the adjacent vertex has not been visited
-                DFSUtil(neighbor, visited, transposedAdj, component);  // Recursive call for the adjacent vertex
-            }
-        }
-    }
+    scc::SCC<vector<list<int>>> solver;  // Keeps its buffers between queries
+};
 
-    // Helper method to get the transposed graph
-    list<int>* getTranspose() {
-        list<int>* transposedAdj = new list<int>[n];  // Create an empty transposed graph
-        for (int v = 0; v < n; ++v) {  // Iterate over each vertex
-            for (int neighbor : adj[v]) {  // Iterate over all the adjacent vertices
-                transposedAdj[neighbor].push_back(v);  // Add an edge from neighbor to v in the transposed graph
-            }
-        }
-        return transposedAdj;  // Return the transposed graph
-    }
+// Per-connection state of a non-blocking client socket
+struct Connection {
+    string input;           // received bytes not parsed into lines yet
+    string output;          // responses the socket has not accepted yet
+    size_t outputSent = 0;  // bytes at the front of output that are already sent
+    bool reading = true;    // in the master set for reading
+    int pendingEdges = 0;   // edges of a "Newgraph" still to be received
 };
 
-// Function to handle the "Newgraph" command
-void handleNewGraph(Graph*& graph, int n, int m, int client_fd) {
+// Function to get the number of response bytes still waiting for the socket
+size_t pendingOutput(const Connection& conn) {
+    return conn.output.size() - conn.outputSent;
+}
+
+// Function to handle the "Newgraph" command; the edges arrive as the next lines
+void handleNewGraph(Graph*& graph, int n, int m, Connection& conn) {
     delete graph;  // Delete the old graph if it exists
     graph = new Graph(n);  // Create a new graph with n vertices
-    char buffer[256];
+    conn.pendingEdges = m;
+    if (m <= 0) {
+        conn.pendingEdges = 0;
+        conn.output += "Graph created.\n";
+    }
+}
+
+// Function to handle one edge line of a "Newgraph" command
+void handleEdgeLine(Graph*& graph, const string& line, Connection& conn) {
     int u, v;
-    for (int i = 0; i < m; ++i) {  // Read m edges
-        int bytes_received = recv(client_fd, buffer, sizeof(buffer), 0);
-        if (bytes_received <= 0) {
-            perror("recv");
-            return;
-        }
-        buffer[bytes_received] = '\0';
-        sscanf(buffer, "%d %d", &u, &v);
+    if (sscanf(line.c_str(), "%d %d", &u, &v) == 2) {
         graph->addEdge(u, v);
     }
-    send(client_fd, "Graph created.\n", 15, 0);
+    if (--conn.pendingEdges == 0) {
+        conn.output += "Graph created.\n";
+    }
 }
 
 // Function to handle the "Newedge" command
-void handleNewEdge(Graph*& graph, int u, int v, int client_fd) {
+void handleNewEdge(Graph*& graph, int u, int v, Connection& conn) {
     graph->addEdge(u, v);
-    send(client_fd, "Edge added.\n", 12, 0);
+    conn.output += "Edge added.\n";
 }
 
 // Function to handle the "Removeedge" command
-void handleRemoveEdge(Graph*& graph, int u, int v, int client_fd) {
+void handleRemoveEdge(Graph*& graph, int u, int v, Connection& conn) {
     graph->removeEdge(u, v);
-    send(client_fd, "Edge removed.\n", 14, 0);
+    conn.output += "Edge removed.\n";
 }
 
 // Function to handle the "Kosaraju" command
-void handleKosaraju(Graph*& graph, int client_fd) {
+void handleKosaraju(Graph*& graph, Connection& conn) {
     if (graph != nullptr) {
-        string result = graph->kosaraju();
-        send(client_fd, result.c_str(), result.size(), 0);
+        conn.output += graph->kosaraju();
     } else {
-        send(client_fd, "No graph available. Use 'Newgraph' command to create a graph first.\n", 67, 0);
+        conn.output += "No graph available. Use 'Newgraph' command to create a graph first.\n";
     }
 }
 
+// Function to handle one command line of a client
+void handleCommand(Graph*& graph, const string& command, Connection& conn) {
+    istringstream iss(command);
+    string cmd;
+    iss >> cmd;
+
+    if (cmd == "Newgraph") {
+        int n, m;
+        iss >> n >> m;
+        handleNewGraph(graph, n, m, conn);
+    } else if (cmd == "Kosaraju") {
+        handleKosaraju(graph, conn);
+    } else if (cmd == "Newedge") {
+        int u, v;
+        iss >> u >> v;
+        handleNewEdge(graph, u, v, conn);
+    } else if (cmd == "Removeedge") {
+        int u, v;
+        iss >> u >> v;
+        handleRemoveEdge(graph, u, v, conn);
+    } else {
+        conn.output += "Invalid command.\n";
+    }
+}
+
+// Function to send as much pending output as the socket takes; returns false if the connection broke
+bool flushOutput(int fd, Connection& conn) {
+    while (pendingOutput(conn) > 0) {
+        ssize_t sent = send(fd, conn.output.data() + conn.outputSent, pendingOutput(conn), MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;  // the socket buffer is full, the rest goes out when it is writable again
+            }
+            perror("send");
+            return false;
+        }
+        conn.outputSent += sent;
+    }
+    if (conn.outputSent == conn.output.size()) {
+        conn.output.clear();
+        conn.outputSent = 0;
+    } else if (conn.outputSent > conn.output.size() / 2) {
+        conn.output.erase(0, conn.outputSent);  // compact now and then instead of on every send
+        conn.outputSent = 0;
+    }
+    return true;
+}
+
+// Function to run the complete lines of a client, send what the socket takes and update the
+// fd sets; returns false if the connection must be closed
+bool serviceConnection(int fd, Connection& conn, Graph*& graph, fd_set& master, fd_set& write_master) {
+    size_t start = 0, end;
+    while (true) {
+        if (!flushOutput(fd, conn)) {
+            return false;
+        }
+        if (pendingOutput(conn) > highWaterMark || (end = conn.input.find('\n', start)) == string::npos) {
+            break;  // waiting for the client to drain its responses, or for more input
+        }
+        string line = conn.input.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);  // telnet ends lines with \r\n
+        }
+        if (conn.pendingEdges > 0) {
+            handleEdgeLine(graph, line, conn);
+        } else {
+            handleCommand(graph, line, conn);
+        }
+    }
+    conn.input.erase(0, start);
+    if (conn.input.size() > MAX_LINE && conn.input.find('\n') == string::npos) {
+        fprintf(stderr, "selectserver: socket %d sent a line longer than %zu bytes\n", fd, MAX_LINE);
+        return false;
+    }
+
+    // watch for writability only while output is pending
+    if (pendingOutput(conn) > 0) {
+        FD_SET(fd, &write_master);
+    } else {
+        FD_CLR(fd, &write_master);
+    }
+    // stop reading above the high-water mark and resume below the low-water mark, so a client
+    // that does not drain its responses is held back by TCP flow control instead of our memory
+    bool wantRead = pendingOutput(conn) <= (conn.reading ? highWaterMark : lowWaterMark);
+    if (wantRead) {
+        FD_SET(fd, &master);
+    } else {
+        FD_CLR(fd, &master);
+    }
+    conn.reading = wantRead;
+    return true;
+}
+
 void *get_in_addr(struct sockaddr *sa) {
     if (sa->sa_family == AF_INET) {
         return &(((struct sockaddr_in*)sa)->sin_addr);
@@ -163,9 +223,12 @@ void *get_in_addr(struct sockaddr *sa) {
     return &(((struct sockaddr_in6*)sa)->sin6_addr);
 }
 
-int main(void) {
+int main(int argc, char *argv[]) {
     fd_set master;    // master file descriptor list
     fd_set read_fds;  // temp file descriptor list for select()
+    fd_set write_master;  // sockets with pending output
+    fd_set write_fds;     // temp writable list for select()
+    map<int, Connection> conns;  // state of every client socket
     int fdmax;        // maximum file descriptor number
 
     int listener;     // listening socket descriptor
@@ -173,18 +236,29 @@ int main(void) {
     struct sockaddr_storage remoteaddr; // client address
     socklen_t addrlen;
 
-    char buf[256];    // buffer for client data
+    char buf[64 * 1024];  // buffer for client data
     int nbytes;
 
     char remoteIP[INET6_ADDRSTRLEN];
 
     int yes=1;        // for setsockopt() SO_REUSEADDR, below
-    int i, j, rv;
+    int i, rv;
 
     struct addrinfo hints, *ai, *p;
 
     FD_ZERO(&master);    // clear the master and temp sets
     FD_ZERO(&read_fds);
+    FD_ZERO(&write_master);
+    FD_ZERO(&write_fds);
+
+    // optional high- and low-water marks for pending output, in KB
+    if (argc > 1) {
+        highWaterMark = strtoul(argv[1], NULL, 10) * 1024;
+    }
+    if (argc > 2) {
+        lowWaterMark = strtoul(argv[2], NULL, 10) * 1024;
+    }
+    lowWaterMark = min(lowWaterMark, highWaterMark);
 
     // get us a socket and bind it
     memset(&hints, 0, sizeof hints);
@@ -238,7 +312,8 @@ int main(void) {
 
     for(;;) {
         read_fds = master; // copy it
-        if (select(fdmax+1, &read_fds, NULL, NULL, NULL) == -1) {
+        write_fds = write_master;
+        if (select(fdmax+1, &read_fds, &write_fds, NULL, NULL) == -1) {
             perror("select");
             exit(4);
         }
@@ -256,6 +331,8 @@ int main(void) {
                     if (newfd == -1) {
                         perror("accept");
                     } else {
+                        fcntl(newfd, F_SETFL, fcntl(newfd, F_GETFL, 0) | O_NONBLOCK); // never block the loop on it
+                        conns[newfd] = Connection();
                         FD_SET(newfd, &master); // add to master set
                         if (newfd > fdmax) {    // keep track of the max
                             fdmax = newfd;
@@ -269,7 +346,11 @@ int main(void) {
                     }
                 } else {
                     // handle data from a client
-                    if ((nbytes = recv(i, buf, sizeof buf, 0)) <= 0) {
+                    nbytes = recv(i, buf, sizeof buf, 0);
+                    if (nbytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                        continue; // nothing there after all
+                    }
+                    if (nbytes <= 0) {
                         // got error or connection closed by client
                         if (nbytes == 0) {
                             // connection closed
@@ -279,35 +360,29 @@ int main(void) {
                         }
                         close(i); // bye!
                         FD_CLR(i, &master); // remove from master set
-                    } else {
-                        // we got some data from a client
-                        buf[nbytes] = '\0';
-                        string command(buf);
-                        istringstream iss(command);
-                        string cmd;
-                        iss >> cmd;
-
-                        if (cmd == "Newgraph") {
-                            int n, m;
-                            iss >> n >> m;
-                            handleNewGraph(graph, n, m, i);
-                        } else if (cmd == "Kosaraju") {
-                            handleKosaraju(graph, i);
-                        } else if (cmd == "Newedge") {
-                            int u, v;
-                            iss >> u >> v;
-                            handleNewEdge(graph, u, v, i);
-                        } else if (cmd == "Removeedge") {
-                            int u, v;
-                            iss >> u >> v;
-                            handleRemoveEdge(graph, u, v, i);
-                        } else {
-                            const char *msg = "Invalid command.\n";
-                            send(i, msg, strlen(msg), 0);
-                        }
+                        FD_CLR(i, &write_master);
+                        conns.erase(i);
+                        continue;
+                    }
+                    // we got some data from a client, run the complete lines
+                    conns[i].input.append(buf, nbytes);
+                    if (!serviceConnection(i, conns[i], graph, master, write_master)) {
+                        close(i);
+                        FD_CLR(i, &master);
+                        FD_CLR(i, &write_master);
+                        conns.erase(i);
+                        continue;
                     }
                 } // END handle data from client
             } // END got new incoming connection
+            if (FD_ISSET(i, &write_fds) && conns.count(i)) { // room for more output
+                if (!serviceConnection(i, conns[i], graph, master, write_master)) {
+                    close(i);
+                    FD_CLR(i, &master);
+                    FD_CLR(i, &write_master);
+                    conns.erase(i);
+                }
+            }
         } // END looping through file descriptors
     } // END for(;;)
 
@@ -0,0 +1,126 @@
+#ifndef FD_HANDLER_HPP
+#define FD_HANDLER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Callback of a file descriptor, a move-only replacement for std::function<void(int)>.
+// Callables up to INLINE_SIZE bytes (function pointers, lambdas with a few captures) are stored
+// inside the handler, larger ones on the heap. Callables that are trivially copyable are moved
+// with a memcpy and need no destructor, so handing a handler around costs no indirect call.
+class FdHandler {
+public:
+    static const size_t INLINE_SIZE = 48;
+
+    FdHandler() : invoker(nullptr), manager(nullptr) {}
+
+    FdHandler(std::nullptr_t) : invoker(nullptr), manager(nullptr) {}
+
+    // Wraps any callable that takes the fd
+    template <typename F, typename = typename std::enable_if<
+                              !std::is_same<typename std::decay<F>::type, FdHandler>::value>::type>
+    FdHandler(F&& f) : invoker(nullptr), manager(nullptr) {
+        typedef typename std::decay<F>::type Callable;
+        store<Callable>(std::forward<F>(f), std::integral_constant<bool, fitsInline<Callable>()>());
+    }
+
+    FdHandler(FdHandler&& other) noexcept : invoker(nullptr), manager(nullptr) {
+        take(other);
+    }
+
+    FdHandler& operator=(FdHandler&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    FdHandler(const FdHandler&) = delete;
+    FdHandler& operator=(const FdHandler&) = delete;
+
+    ~FdHandler() {
+        reset();
+    }
+
+    // Destroys the callable, leaving the handler empty
+    void reset() {
+        if (manager != nullptr) {
+            manager(DESTROY, &storage, nullptr);
+        }
+        invoker = nullptr;
+        manager = nullptr;
+    }
+
+    explicit operator bool() const {
+        return invoker != nullptr;
+    }
+
+    // Calls the callable with the fd
+    void operator()(int fd) {
+        invoker(&storage, fd);
+    }
+
+private:
+    enum Operation { MOVE, DESTROY };
+    typedef void (*Invoker)(void* storage, int fd);
+    typedef void (*Manager)(Operation op, void* storage, void* source);
+
+    typename std::aligned_storage<INLINE_SIZE, alignof(std::max_align_t)>::type storage;
+    Invoker invoker;  // Calls the stored callable, nullptr if the handler is empty
+    Manager manager;  // Moves and destroys the stored callable, nullptr if a memcpy does
+
+    template <typename Callable>
+    static constexpr bool fitsInline() {
+        return sizeof(Callable) <= INLINE_SIZE && alignof(Callable) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<Callable>::value;
+    }
+
+    // Stores a small callable inside the handler
+    template <typename Callable, typename F>
+    void store(F&& f, std::true_type) {
+        new (&storage) Callable(std::forward<F>(f));
+        invoker = [](void* p, int fd) { (*static_cast<Callable*>(p))(fd); };
+        if (!std::is_trivially_copyable<Callable>::value) {
+            manager = [](Operation op, void* p, void* source) {
+                if (op == MOVE) {
+                    new (p) Callable(std::move(*static_cast<Callable*>(source)));
+                }
+                static_cast<Callable*>(op == MOVE ? source : p)->~Callable();
+            };
+        }
+    }
+
+    // Stores a large callable on the heap; the handler only holds the pointer
+    template <typename Callable, typename F>
+    void store(F&& f, std::false_type) {
+        Callable* callable = new Callable(std::forward<F>(f));
+        std::memcpy(&storage, &callable, sizeof(callable));
+        invoker = [](void* p, int fd) { (**static_cast<Callable**>(p))(fd); };
+        manager = [](Operation op, void* p, void* source) {
+            if (op == MOVE) {
+                std::memcpy(p, source, sizeof(Callable*));  // The callable itself stays where it is
+            } else {
+                delete *static_cast<Callable**>(p);
+            }
+        };
+    }
+
+    // Moves the callable of another handler into this empty one
+    void take(FdHandler& other) {
+        if (other.manager != nullptr) {
+            other.manager(MOVE, &storage, &other.storage);
+        } else if (other.invoker != nullptr) {
+            std::memcpy(&storage, &other.storage, INLINE_SIZE);
+        }
+        invoker = other.invoker;
+        manager = other.manager;
+        other.invoker = nullptr;
+        other.manager = nullptr;  // The source was moved from, there is nothing left to destroy
+    }
+};
+
+#endif // FD_HANDLER_HPP
@@ -1,65 +1,324 @@
 #include "reactor.hpp"
 #include <iostream>
 #include <thread>
+#include <cstdint>
+#include <cerrno>
+#include <algorithm>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+// Niceness of the worker threads relative to the reactor thread
+static const int WORKER_NICE = 10;
 
 // Constructor initializes the fd sets and variables
-Reactor::Reactor() : fdMax(0), running(false) {
+Reactor::Reactor() : fdMax(0), running(false), handlers(FD_SETSIZE), dispatchFd(-1), dispatchWhich(nullptr),
+                     dispatchChanged(false), started(false), loopId(std::thread::id()),
+                     startTime(std::chrono::steady_clock::now()), stopping(false) {
     FD_ZERO(&masterSet);  // Initialize the master set to be empty
     FD_ZERO(&readSet);    // Initialize the read set to be empty
+    FD_ZERO(&writeMasterSet);  // Nothing waits for writability yet
+    FD_ZERO(&writeSet);
+    wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);  // Other threads write to it to wake the loop
+    if (wakeupFd == -1) {
+        perror("eventfd");
+    } else {
+        addFdToReactor(wakeupFd, [this](int fd) { drainCommands(fd); });
+    }
 }
 
 // Destructor stops the reactor
 Reactor::~Reactor() {
     stopReactor();  // Ensure the reactor is stopped when destroyed
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        stopping = true;  // Workers exit once the queue is empty
+    }
+    workCond.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    if (wakeupFd != -1) {
+        close(wakeupFd);
+    }
 }
 
 // Starts the reactor and returns a pointer to it
 void* Reactor::startReactor() {
+    if (started.exchange(true)) {
+        return this;  // Already running
+    }
     running = true;  // Set the running flag to true
-    std::thread(&Reactor::run, this).detach();  // Run the reactor loop in a separate thread
+    loopThread = std::thread(&Reactor::run, this);  // Run the reactor loop in a separate thread
     return this;  // Return a pointer to the reactor
 }
 
 // Adds a file descriptor to the reactor with the specified callback function
 int Reactor::addFdToReactor(int fd, reactorFunc func) {
-    FD_SET(fd, &masterSet);  // Add the file descriptor to the master set
-    if (fd > fdMax) {  // Update the maximum file descriptor if necessary
-        fdMax = fd;
+    if (fd < 0 || fd >= FD_SETSIZE) {
+        return -1;  // select() cannot watch it
     }
-    callbacks[fd] = func;  // Store the callback function for the file descriptor
+    Command command;
+    command.type = Command::ADD_READ;
+    command.fd = fd;
+    command.func = std::move(func);
+    submit(std::move(command));
     return 0;  // Return success
 }
 
 // Removes a file descriptor from the reactor
 int Reactor::removeFdFromReactor(int fd) {
-    FD_CLR(fd, &masterSet);  // Remove the file descriptor from the master set
-    callbacks.erase(fd);  // Erase the callback function for the file descriptor
+    if (fd < 0 || fd >= FD_SETSIZE) {
+        return -1;
+    }
+    Command command;
+    command.type = Command::REMOVE_READ;
+    command.fd = fd;
+    submit(std::move(command));
     return 0;  // Return success
 }
 
-// Stops the reactor
+// Watches a file descriptor for writability with the specified callback function
+int Reactor::addWriteFdToReactor(int fd, reactorFunc func) {
+    if (fd < 0 || fd >= FD_SETSIZE) {
+        return -1;  // select() cannot watch it
+    }
+    Command command;
+    command.type = Command::ADD_WRITE;
+    command.fd = fd;
+    command.func = std::move(func);
+    submit(std::move(command));
+    return 0;  // Return success
+}
+
+// Stops watching a file descriptor for writability
+int Reactor::removeWriteFdFromReactor(int fd) {
+    if (fd < 0 || fd >= FD_SETSIZE) {
+        return -1;
+    }
+    Command command;
+    command.type = Command::REMOVE_WRITE;
+    command.fd = fd;
+    submit(std::move(command));
+    return 0;  // Return success
+}
+
+// Stops the reactor and waits for its loop to exit (unless called from the loop itself)
 int Reactor::stopReactor() {
     running = false;  // Set the running flag to false
+    wakeup();  // select() may sleep until the next timer or forever, so the loop only sees the flag once it wakes up
+    if (loopThread.joinable() && !onLoopThread()) {
+        loopThread.join();
+    }
     return 0;  // Return success
 }
 
+// Starts the worker threads that run posted work
+int Reactor::startWorkers(unsigned threads) {
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.push_back(std::thread(&Reactor::workerLoop, this));
+    }
+    return 0;  // Return success
+}
+
+// Runs work on a worker thread, then its completion on the reactor thread
+int Reactor::postWork(workFunc work, workFunc completion) {
+    if (workers.empty() || wakeupFd == -1) {
+        return -1;  // Nothing could run it
+    }
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        workQueue.push_back(std::make_pair(std::move(work), std::move(completion)));
+    }
+    workCond.notify_one();
+    return 0;  // Return success
+}
+
+// Runs a function on the reactor thread
+int Reactor::runInLoop(workFunc task) {
+    Command command;
+    command.type = Command::RUN;
+    command.task = std::move(task);
+    submit(std::move(command));
+    return 0;  // Return success
+}
+
+// Runs a function on the reactor thread once, after delayMs milliseconds
+TimerId Reactor::addTimer(uint64_t delayMs, workFunc callback) {
+    return timers.add(now() + delayMs, 0, std::move(callback));
+}
+
+// Runs a function on the reactor thread every periodMs milliseconds
+TimerId Reactor::addPeriodicTimer(uint64_t periodMs, workFunc callback) {
+    periodMs = std::max<uint64_t>(periodMs, 1);  // A period of 0 would fire on every tick
+    return timers.add(now() + periodMs, periodMs, std::move(callback));
+}
+
+// Cancels a timer; returns -1 if it already fired or was cancelled
+int Reactor::cancelTimer(TimerId id) {
+    return timers.cancel(id) ? 0 : -1;
+}
+
+// Returns the milliseconds since the reactor was created, the clock of the timers
+uint64_t Reactor::now() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// Main loop of a worker thread
+void Reactor::workerLoop() {
+    // Lower the priority of this thread only, so the loop preempts it as soon as a socket is ready
+    if (setpriority(PRIO_PROCESS, syscall(SYS_gettid), WORKER_NICE) == -1) {
+        perror("setpriority");
+    }
+    while (true) {
+        std::pair<workFunc, workFunc> item;
+        {
+            std::unique_lock<std::mutex> lock(workMutex);
+            workCond.wait(lock, [this] { return stopping || !workQueue.empty(); });
+            if (workQueue.empty()) {
+                return;  // Stopping and nothing left to do
+            }
+            item = std::move(workQueue.front());
+            workQueue.pop_front();
+        }
+
+        item.first();  // Run the work outside of the lock
+
+        Command command;  // The completion goes back through the command queue
+        command.type = Command::RUN;
+        command.task = std::move(item.second);
+        commands.push(std::move(command));
+        wakeup();  // Always wake, the loop may be the one that is idle
+    }
+}
+
+// Checks whether a change can be applied directly instead of being queued
+bool Reactor::onLoopThread() const {
+    return !started || loopId.load() == std::this_thread::get_id();
+}
+
+// Queues a change for the loop and wakes it up
+void Reactor::submit(Command command) {
+    if (onLoopThread()) {
+        apply(command);  // Before the start, and inside callbacks, nobody else touches the sets
+        return;
+    }
+    commands.push(std::move(command));
+    wakeup();
+}
+
+// Wakes the loop out of select()
+void Reactor::wakeup() {
+    uint64_t one = 1;
+    if (wakeupFd != -1 && write(wakeupFd, &one, sizeof(one)) != sizeof(one)) {
+        perror("write");
+    }
+}
+
+// Applies the queued changes (reactor thread only)
+void Reactor::drainCommands(int fd) {
+    uint64_t count;
+    if (read(fd, &count, sizeof(count)) != sizeof(count)) {  // Reset the eventfd counter before draining
+        count = 0;  // Nothing pending, a previous drain already applied everything
+    }
+    Command command;
+    while (commands.pop(command)) {
+        apply(command);
+    }
+}
+
+// Applies one change (reactor thread only)
+void Reactor::apply(Command& command) {
+    int fd = command.fd;
+    switch (command.type) {
+        case Command::ADD_READ:
+            FD_SET(fd, &masterSet);  // Add the file descriptor to the master set
+            if (fd > fdMax) {  // Update the maximum file descriptor if necessary
+                fdMax = fd;
+            }
+            setHandler(fd, &FdSlot::read, std::move(command.func));  // Store the callback function for the file descriptor
+            break;
+        case Command::REMOVE_READ:
+            FD_CLR(fd, &masterSet);  // Remove the file descriptor from the master set
+            setHandler(fd, &FdSlot::read, nullptr);  // Erase the callback function for the file descriptor
+            break;
+        case Command::ADD_WRITE:
+            FD_SET(fd, &writeMasterSet);  // Add the file descriptor to the write master set
+            if (fd > fdMax) {
+                fdMax = fd;
+            }
+            setHandler(fd, &FdSlot::write, std::move(command.func));
+            break;
+        case Command::REMOVE_WRITE:
+            FD_CLR(fd, &writeMasterSet);  // Remove the file descriptor from the write master set
+            setHandler(fd, &FdSlot::write, nullptr);
+            break;
+        case Command::RUN:
+            command.task();  // Completion of posted work
+            break;
+    }
+}
+
+// Stores or removes a callback, deferred if it is the one running (reactor thread only)
+void Reactor::setHandler(int fd, reactorFunc FdSlot::*which, reactorFunc func) {
+    if (fd == dispatchFd && which == dispatchWhich) {
+        dispatchReplacement = std::move(func);  // Destroying the running callable would pull the rug from under it
+        dispatchChanged = true;
+        return;
+    }
+    handlers[fd].*which = std::move(func);
+}
+
+// Calls the read or write callback of a ready fd (reactor thread only)
+void Reactor::dispatch(int fd, reactorFunc FdSlot::*which) {
+    reactorFunc& func = handlers[fd].*which;
+    if (!func) {
+        return;  // Removed since select() returned
+    }
+    dispatchFd = fd;
+    dispatchWhich = which;
+    func(fd);  // Called in place, no lookup and no copy
+    dispatchFd = -1;
+    if (dispatchChanged) {
+        dispatchChanged = false;
+        func = std::move(dispatchReplacement);  // Removed (empty) or replaced while it ran
+    }
+}
+
 // Main loop of the reactor
 void Reactor::run() {
+    loopId = std::this_thread::get_id();  // From now on only this thread touches the sets directly
+    Command command;
+    while (commands.pop(command)) {  // Changes queued between startReactor() and now
+        apply(command);
+    }
+
     while (running) {  // Loop while the reactor is running
         readSet = masterSet;  // Copy the master set to the read set
-        int activity = select(fdMax + 1, &readSet, NULL, NULL, NULL);  // Wait for activity on any file descriptor
+        writeSet = writeMasterSet;  // Copy the write master set to the write set
+        int64_t timeout = timers.nextTimeout(now());  // Sleep no longer than until the next timer
+        struct timeval tv;
+        tv.tv_sec = timeout / 1000;
+        tv.tv_usec = (timeout % 1000) * 1000;
+        int activity = select(fdMax + 1, &readSet, &writeSet, NULL, timeout < 0 ? NULL : &tv);  // Wait for activity on any file descriptor
         if (activity < 0) {  // Check for errors
-            perror("select");  // Print an error message
+            if (errno != EINTR) {
+                perror("select");  // Print an error message
+            }
             continue;  // Continue the loop
         }
 
-        for (int i = 0; i <= fdMax; ++i) {  // Loop over all file descriptors
+        for (int i = 0; i <= fdMax && running; ++i) {  // Loop over all file descriptors
             if (FD_ISSET(i, &readSet)) {  // Check if the file descriptor is ready
-                auto it = callbacks.find(i);  // Find the callback function for the file descriptor
-                if (it != callbacks.end()) {  // If a callback function is found
-                    it->second(i);  // Call the callback function
-                }
+                dispatch(i, &FdSlot::read);  // Call the callback function
+            }
+            if (FD_ISSET(i, &writeSet)) {  // Check if the file descriptor can take more data
+                dispatch(i, &FdSlot::write);  // The read callback may have closed it already
             }
         }
+
+        if (running) {
+            timers.expire(now());  // Fire the timers that are due
+        }
     }
 }
@@ -0,0 +1,305 @@
+// Stress test of the edit log of the reactor server, in two phases.
+//
+// The forced phase lines up the one order of events that random timing hardly ever produces: a job
+// copies the graph for its logged edits and finishes, the loop applies the log before the completion
+// of that job runs, and more edits are made and logged meanwhile. The loop dispatches the ready sockets
+// of one select() in fd order and sees completions only on its next pass, so connections opened in
+// the order of the steps and written to while the loop is busy run the steps back to back; a long run
+// of filler lines on one of them gives the job time to finish. Whether it does is still up to the
+// scheduler, so the order is likely rather than certain; without the version bump in catchUpEdits the
+// server lost edits in about a third of the rounds. The edges 1 -> 2 -> 3 -> 1 are added at the three
+// steps, so all of them survive only if 1, 2 and 3 end up in one SCC.
+//
+// The random phase has several clients add and remove edges while they and the others keep Kosaraju
+// jobs running, in every order the loop happens to run them. Each client only edits the rows u with
+// u % clients == its index, so the final graph follows from what every client sent on its own; the
+// SCCs the server reports at the end must match that graph.
+#include "../scc/scc.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static const char* SENTINEL = "Invalid command.\n";  // Response to "End", marks where a Kosaraju result ends
+
+// Forced phase: graph size, filler lines that keep the loop busy while a job runs, and repetitions
+static const int FORCED_VERTICES = 2000;
+static const int FILLER_LINES = 12000;  // "End" lines, all within one 64 KB recv() of the server
+static const int FORCED_ROUNDS = 100;
+
+// A client connection that sends commands and reads their responses
+class StressClient {
+public:
+    explicit StressClient(int port) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd == -1 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+            perror("connect");
+            exit(1);
+        }
+    }
+
+    ~StressClient() { close(fd); }
+
+    void sendLine(const string& line) { sendRaw(line + "\n"); }
+
+    // Function to send several lines with one send(), so the server reads them together
+    void sendRaw(const string& data) {
+        for (size_t sent = 0; sent < data.size(); ) {
+            ssize_t bytes = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (bytes <= 0) {
+                perror("send");
+                exit(1);
+            }
+            sent += bytes;
+        }
+    }
+
+    // Function to read responses until one ends with the given text; returns everything before it
+    string readUntil(const string& end) {
+        size_t pos;
+        while ((pos = buffer.find(end)) == string::npos) {
+            char chunk[65536];
+            ssize_t bytes = recv(fd, chunk, sizeof(chunk), 0);
+            if (bytes <= 0) {
+                cerr << "Server closed the connection" << endl;
+                exit(1);
+            }
+            buffer.append(chunk, bytes);
+        }
+        string before = buffer.substr(0, pos);
+        buffer.erase(0, pos + end.size());
+        return before;
+    }
+
+    // Function to run "Kosaraju" and return its components, each sorted, in sorted order
+    vector<vector<int>> kosaraju() {
+        sendLine("Kosaraju");
+        sendLine("End");  // Queued behind the job, so its response follows the whole result
+        return readSCCs();
+    }
+
+    // Function to read a Kosaraju result that "End" was sent after
+    vector<vector<int>> readSCCs() {
+        stringstream ss(readUntil(SENTINEL));
+        vector<vector<int>> sccs;
+        string line;
+        while (getline(ss, line)) {
+            size_t colon = line.find(':');
+            if (line.compare(0, 4, "SCC ") != 0 || colon == string::npos) {
+                continue;
+            }
+            stringstream vertices(line.substr(colon + 1));
+            vector<int> scc;
+            int v;
+            while (vertices >> v) {
+                scc.push_back(v);
+            }
+            sort(scc.begin(), scc.end());
+            sccs.push_back(scc);
+        }
+        sort(sccs.begin(), sccs.end());
+        return sccs;
+    }
+
+private:
+    int fd;
+    string buffer;
+};
+
+// Function to find the components of the expected graph the way kosaraju() returns them
+vector<vector<int>> expectedSCCs(const vector<vector<char>>& present) {
+    int n = present.size();
+    vector<vector<int>> adj(n);
+    for (int u = 0; u < n; ++u) {
+        for (int v = 0; v < n; ++v) {
+            if (present[u][v]) {
+                adj[u].push_back(v);
+            }
+        }
+    }
+    scc::Components components = scc::find(adj);
+    vector<vector<int>> sccs;
+    for (int i = 0; i < components.size(); ++i) {
+        vector<int> scc;
+        for (const int* vertex = components.begin(i); vertex != components.end(i); ++vertex) {
+            scc.push_back(*vertex + 1);
+        }
+        sort(scc.begin(), scc.end());
+        sccs.push_back(scc);
+    }
+    sort(sccs.begin(), sccs.end());
+    return sccs;
+}
+
+// Function to find the component of a vertex in a result of kosaraju()
+const vector<int>* componentOf(const vector<vector<int>>& sccs, int vertex) {
+    for (const vector<int>& scc : sccs) {
+        if (binary_search(scc.begin(), scc.end(), vertex)) {
+            return &scc;
+        }
+    }
+    return nullptr;
+}
+
+// Function to run the forced phase; returns the number of rounds that lost an edit
+int forcedInterleaving(int port) {
+    StressClient setup(port);
+    mt19937 rng(0);
+    stringstream graph;  // A chain with random shortcuts on vertices 4 and up, so every job takes a while
+    int edges = 0;
+    for (int v = 4; v <= FORCED_VERTICES; ++v) {
+        if (v < FORCED_VERTICES) {
+            graph << v << " " << v + 1 << "\n";
+            ++edges;
+        }
+        graph << v << " " << 4 + rng() % (FORCED_VERTICES - 3) << "\n";
+        ++edges;
+    }
+    setup.sendLine("Newgraph " + to_string(FORCED_VERTICES) + " " + to_string(edges));
+    setup.readUntil("Send the edges.\n");
+    setup.sendRaw(graph.str());
+    setup.readUntil("New graph created.\n");
+
+    // Connected in step order and each checked with a round trip, so their server-side fds ascend too
+    const int STEPS = 5;
+    vector<StressClient*> steps;
+    for (int i = 0; i < STEPS; ++i) {
+        steps.push_back(new StressClient(port));
+        steps[i]->sendLine("End");
+        steps[i]->readUntil(SENTINEL);
+    }
+    StressClient& busy = *steps[0];    // Keeps the loop away from select() while the others are written
+    StressClient& holder = *steps[1];  // Its job shares adj, so the next edit is logged
+    StressClient& copier = *steps[2];  // Its job copies adj for that edit and finishes
+    StressClient& applier = *steps[3]; // Waits for that, applies the log, edits adj and shares it again
+    StressClient& logger = *steps[4];  // Its edit is logged while the applier's job runs
+
+    string filler;
+    for (int i = 0; i < FILLER_LINES; ++i) {
+        filler += "End\n";
+    }
+    int lost = 0;
+    for (int round = 0; round < FORCED_ROUNDS; ++round) {
+        setup.sendRaw("Removeedge 1 2\nRemoveedge 2 3\nRemoveedge 3 1\n");
+        setup.readUntil("Edge removed.\nEdge removed.\nEdge removed.\n");
+
+        busy.sendRaw(filler);
+        holder.sendRaw("Kosaraju\nEnd\n");
+        copier.sendRaw("Newedge 1 2\nKosaraju\nEnd\n");
+        applier.sendRaw(filler + "Newedge 2 3\nKosaraju\nEnd\n");
+        logger.sendRaw("Newedge 3 1\nEnd\n");
+
+        for (int i = 0; i < FILLER_LINES; ++i) {
+            busy.readUntil(SENTINEL);
+        }
+        holder.readSCCs();
+        copier.readUntil("Edge added.\n");
+        copier.readSCCs();
+        applier.readUntil("Edge added.\n");
+        applier.readSCCs();
+        logger.readUntil("Edge added.\n");
+        logger.readUntil(SENTINEL);
+
+        vector<vector<int>> sccs = setup.kosaraju();
+        const vector<int>* cycle = componentOf(sccs, 1);
+        if (cycle == nullptr || *cycle != vector<int>{1, 2, 3}) {
+            ++lost;
+        }
+    }
+    for (StressClient* client : steps) {
+        delete client;
+    }
+    cout << "Forced interleaving: " << FORCED_ROUNDS - lost << " of " << FORCED_ROUNDS
+         << " rounds kept all three edits" << endl;
+    return lost;
+}
+
+// Main function: edit_stress [port] [clients] [vertices] [rounds]
+int main(int argc, char* argv[]) {
+    int port = argc > 1 ? atoi(argv[1]) : 9034;
+    int clients = argc > 2 ? atoi(argv[2]) : 8;
+    int n = argc > 3 ? atoi(argv[3]) : 2000;
+    int rounds = argc > 4 ? atoi(argv[4]) : 2000;
+    if (clients < 1 || n < clients || rounds < 1) {
+        cerr << "Usage: " << argv[0] << " [port] [clients] [vertices >= clients] [rounds]" << endl;
+        return 1;
+    }
+
+    int lost = forcedInterleaving(port);
+
+    {
+        StressClient setup(port);
+        setup.sendLine("Newgraph " + to_string(n) + " 0");
+        setup.readUntil("New graph created.\n");
+    }
+
+    vector<vector<char>> present(n, vector<char>(n, 0));  // Rows are written by their owning client only
+    atomic<int> jobs(0);
+    vector<thread> threads;
+    for (int t = 0; t < clients; ++t) {
+        threads.push_back(thread([&, t] {
+            StressClient client(port);
+            mt19937 rng(t + 1);
+            int rows = (n - 1 - t) / clients + 1;  // Rows t, t + clients, ...
+            vector<pair<int, int>> owned;  // Edges of those rows that are in the graph now
+            for (int r = 0; r < rounds; ++r) {
+                int dice = rng() % 16;
+                if (dice == 0) {
+                    client.kosaraju();  // Only the final result is checked, mid-run ones race with the others
+                    ++jobs;
+                    continue;
+                }
+                // Around two edges per vertex the SCCs are many and small, so a lost edit shows in them
+                if (owned.size() < 2 * static_cast<size_t>(rows) || dice < 8) {
+                    int u = t + clients * static_cast<int>(rng() % rows);
+                    int v = rng() % n;
+                    client.sendLine("Newedge " + to_string(u + 1) + " " + to_string(v + 1));
+                    client.readUntil("Edge added.\n");
+                    if (!present[u][v]) {
+                        present[u][v] = 1;
+                        owned.push_back(make_pair(u, v));
+                    }
+                } else {
+                    size_t i = rng() % owned.size();
+                    int u = owned[i].first, v = owned[i].second;
+                    client.sendLine("Removeedge " + to_string(u + 1) + " " + to_string(v + 1));
+                    client.readUntil("Edge removed.\n");
+                    present[u][v] = 0;
+                    owned[i] = owned.back();
+                    owned.pop_back();
+                }
+            }
+        }));
+    }
+    for (thread& worker : threads) {
+        worker.join();
+    }
+
+    StressClient check(port);
+    vector<vector<int>> got = check.kosaraju();
+    vector<vector<int>> expected = expectedSCCs(present);
+    cout << clients << " clients, " << rounds << " rounds each, " << jobs << " Kosaraju jobs: ";
+    if (got != expected) {
+        cout << "FAILED, the server reports " << got.size() << " SCCs, the edits give " << expected.size() << endl;
+        return 1;
+    }
+    cout << "the server's " << got.size() << " SCCs match the edits" << endl;
+    return lost > 0 ? 1 : 0;
+}
@@ -2,7 +2,6 @@
 #include <iostream>
 #include <vector>
 #include <list>
-#include <stack>
 #include <sstream>
 #include <string>
 #include <cstring>
@@ -14,115 +13,112 @@
 #include <algorithm>
 #include <chrono>
 #include <thread>
+#include <memory>
+#include <map>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <csignal>
+#include <pthread.h>
+#include "../scc/scc.hpp"
 
 using namespace std;
 
+typedef vector<list<int>> AdjacencyList;
+
+// An edit made while SCC jobs still read the graph (0-based vertices)
+struct GraphEdit {
+    bool add;  // Newedge, or Removeedge
+    int u, v;
+};
+
 // Global variables to store the graph
-vector<list<int>> adj; // Adjacency list for the graph
-vector<list<int>> transposedAdj; // Transposed adjacency list for the graph
+shared_ptr<AdjacencyList> adj = make_shared<AdjacencyList>(); // Adjacency list, shared read-only with running SCC jobs
+vector<GraphEdit> pendingEdits;  // Edits not in adj yet because a job reads it; the graph is adj plus these
+unsigned long graphVersion = 0;  // Bumped whenever adj is replaced or the log applied to it, so older job copies are stale
 int n, m;  // Number of vertices and edges
+Reactor reactor;  // Reactor that serves all clients
 
-// Function to perform DFS and fill the stack
-void fillOrder(int v, vector<bool>& visited, stack<int>& Stack) {
-    visited[v] = true;  // Mark the current node as visited
-    for (int neighbor : adj[v]) {  // Iterate over all the adjacent vertices
-        if (!visited[neighbor]) {  // If the adjacent vertex has not been visited
-            fillOrder(neighbor, visited, Stack);  // Recursive call for the adjacent vertex
-        }
+// Function to apply one edit to a graph
+void applyEdit(AdjacencyList& graph, const GraphEdit& edit) {
+    if (edit.add) {
+        graph[edit.u].push_back(edit.v);  // Add the edge to the adjacency list
+    } else {
+        graph[edit.u].remove(edit.v);  // Remove the edge from the adjacency list
     }
-    Stack.push(v);  // Push the vertex to the stack after all its adjacent vertices are processed
 }
 
-// Function to perform DFS on the transposed graph
-void DFSUtil(int v, vector<bool>& visited, vector<int>& component) {
-    visited[v] = true;  // Mark the current node as visited
-    component.push_back(v);  // Add this vertex to the current component
-    for (int neighbor : transposedAdj[v]) {  // Iterate over all the adjacent vertices in the transposed graph
-        if (!visited[neighbor]) {  // If the adjacent vertex has not been visited
-            DFSUtil(neighbor, visited, component);  // Recursive call for the adjacent vertex
-        }
+// Function to apply the logged edits once no job reads adj any more
+void catchUpEdits() {
+    if (adj.use_count() > 1 || pendingEdits.empty()) {
+        return;
     }
-}
-
-// Function to get the transposed graph
-void getTranspose() {
-    transposedAdj = vector<list<int>>(n);  // Create a transposed adjacency list with n vertices
-    for (int v = 0; v < n; ++v) {  // Iterate over each vertex
-        for (int neighbor : adj[v]) {  // Iterate over all the adjacent vertices
-            transposedAdj[neighbor].push_back(v);  // Add an edge from neighbor to v in the transposed graph
-        }
+    for (const GraphEdit& edit : pendingEdits) {
+        applyEdit(*adj, edit);
     }
+    pendingEdits.clear();
+    graphVersion++;  // A job that already released adj may still hold a copy built from the old log
 }
 
-// Function to find and return all strongly connected components (SCCs)
-string findSCCs() {
-    stack<int> Stack;  // Stack to store the order of vertices by finishing times
-    vector<bool> visited(n, false);  // Visited array to keep track of visited vertices
-
-    // Perform DFS to fill the stack with vertices in order of finishing times
-    for (int i = 0; i < n; ++i) {
-        if (!visited[i]) {
-            fillOrder(i, visited, Stack);
-        }
+// Function to change the graph. While a job reads it, the edit is only logged: copying the whole graph
+// here would stall the loop for O(V + E); the next job applies the log to its own copy on a worker.
+void editGraph(const GraphEdit& edit) {
+    catchUpEdits();
+    if (adj.use_count() > 1) {
+        pendingEdits.push_back(edit);
+    } else {
+        applyEdit(*adj, edit);
     }
+}
 
-    getTranspose();  // Get the transposed graph
-
-    fill(visited.begin(), visited.end(), false);  // Mark all vertices as not visited for the second DFS
+// Function to find and return all strongly connected components (SCCs); only reads the given graph
+string findSCCs(const AdjacencyList& graph) {
+    scc::Components sccs = scc::find(graph);  // Iterative Kosaraju of the shared SCC library, own buffers per job
 
     stringstream ss;  // String stream to store the SCCs result
-    int scc_count = 0;  // Counter for SCCs
-
-    // Process all vertices in order defined by the stack
-    while (!Stack.empty()) {
-        int v = Stack.top();
-        Stack.pop();
-
-        if (!visited[v]) {
-            vector<int> component;  // Vector to store the current SCC
-            DFSUtil(v, visited, component);  // Perform DFS on the transposed graph
-            ss << "SCC " << ++scc_count << " is: ";
-            for (int vertex : component) {
-                ss << (vertex + 1) << " ";  // Add vertices to the SCC result
-            }
-            ss << endl;
+    for (int i = 0; i < sccs.size(); ++i) {
+        ss << "SCC " << (i + 1) << " is: ";
+        for (const int* vertex = sccs.begin(i); vertex != sccs.end(i); ++vertex) {
+            ss << (*vertex + 1) << " ";  // Add vertices to the SCC result
         }
+        ss << endl;
     }
 
     return ss.str();  // Return the result string
 }
 
-// Function to handle the "Newgraph" command
-void handleNewGraph(int vertices, int edges, int client_fd) {
-    n = vertices;  // Set the number of vertices
-    m = edges;  // Set the number of edges
-    adj = vector<list<int>>(n);  // Initialize the adjacency list with n vertices
-    char buf[256];  // Buffer to store received data
-    int u, v;
+// A Kosaraju request on the worker pool
+struct SCCJob {
+    shared_ptr<const AdjacencyList> graph;  // Graph as it was when the job started, released when it is done
+    vector<GraphEdit> edits;                // Pending edits at that time, on top of graph
+    unsigned long version = 0;              // graphVersion at that time
+    shared_ptr<AdjacencyList> rebuilt;      // graph with edits applied, built on the worker if there were any
+    string result;
+};
 
-    for (int i = 0; i < m; ++i) {
-        memset(buf, 0, sizeof(buf));  // Clear the buffer
-        int nbytes = recv(client_fd, buf, sizeof(buf) - 1, 0);  // Receive data from the client
-        if (nbytes <= 0) {
-            if (nbytes == 0) {
-                cout << "Socket " << client_fd << " hung up" << endl;
-            } else {
-                perror("recv");
-            }
-            close(client_fd);  // Close the client socket
-            return;
-        }
-        buf[nbytes] = '\0';  // Null-terminate the buffer
-        stringstream ss(buf);  // Create a string stream from the buffer
-        ss >> u >> v;  // Parse the edge endpoints
-        if (u < 1 || u > n || v < 1 || v > n) {
-            cerr << "Invalid edge: " << u << " " << v << endl;
-            --i; // Retry the current edge
-            continue;
+// Function to run a job on a worker thread; the copy for the pending edits is made here, not on the loop
+void runSCCJob(SCCJob& job) {
+    if (job.edits.empty()) {
+        job.result = findSCCs(*job.graph);
+    } else {
+        job.rebuilt = make_shared<AdjacencyList>(*job.graph);
+        for (const GraphEdit& edit : job.edits) {
+            applyEdit(*job.rebuilt, edit);
         }
-        adj[u - 1].push_back(v - 1);  // Add the edge to the adjacency list
+        job.result = findSCCs(*job.rebuilt);
     }
-    cout << "Graph with " << n << " vertices and " << m << " edges created." << endl;
+    job.graph.reset();
+}
+
+// Function to finish a job on the reactor thread: its rebuilt graph becomes adj if nothing replaced adj
+// meanwhile, so the edit log shrinks by what the copy already contains
+void finishSCCJob(SCCJob& job) {
+    if (job.rebuilt && job.version == graphVersion && job.edits.size() <= pendingEdits.size()) {
+        adj = move(job.rebuilt);
+        pendingEdits.erase(pendingEdits.begin(), pendingEdits.begin() + job.edits.size());
+        graphVersion++;  // Logs of jobs that are still running refer to the old adj
+    }
+    job.rebuilt.reset();
 }
 
 // Function to handle the "Newedge" command
@@ -131,7 +127,7 @@ void handleNewEdge(int u, int v) {
         cerr << "Invalid edge: " << u << " " << v << endl;
         return;
     }
-    adj[u - 1].push_back(v - 1);  // Add the edge to the adjacency list
+    editGraph(GraphEdit{true, u - 1, v - 1});  // Add the edge to the adjacency list
     cout << "Edge added: " << u << " -> " << v << endl;
 }
 
@@ -141,7 +137,7 @@ void handleRemoveEdge(int u, int v) {
         cerr << "Invalid edge: " << u << " " << v << endl;
         return;
     }
-    adj[u - 1].remove(v - 1);  // Remove the edge from the adjacency list
+    editGraph(GraphEdit{false, u - 1, v - 1});  // Remove the edge from the adjacency list
     cout << "Edge removed: " << u << " -> " << v << endl;
 }
 
@@ -152,62 +148,338 @@ string toLowerCase(const string& str) {
     return result;  // Return the lowercase string
 }
 
-// Function to handle client commands
-void handleClient(int client_fd) {
-    char buf[1024];  // Buffer to store received data
-    int nbytes = recv(client_fd, buf, sizeof(buf) - 1, 0);  // Receive data from the client
-    if (nbytes <= 0) {
-        if (nbytes == 0) {
-            cout << "Socket " << client_fd << " hung up" << endl;
-        } else {
-            perror("recv");
+// Per-connection state of a non-blocking client socket
+struct Connection {
+    unsigned long id = 0;           // Tells a reused fd apart from the connection a job was started for
+    string input;                   // Received bytes not parsed into lines yet
+    string output;                  // Responses the socket has not accepted yet
+    size_t outputSent = 0;          // Bytes at the front of output that are already sent
+    bool reading = false;           // Registered for reading in the reactor
+    bool writing = false;           // Registered for writability in the reactor
+    bool busy = false;              // A Kosaraju job runs for this client, its next commands wait
+    int pendingEdges = 0;           // Edges of a "Newgraph" still to be received
+    int newVertices = 0;            // Vertex count of that "Newgraph"
+    int newEdges = 0;               // Edge count of that "Newgraph"
+    shared_ptr<AdjacencyList> newGraph;  // Graph being received, installed once it is complete
+    uint64_t lastActivity = 0;      // Reactor time of the last byte received or sent
+    TimerId idleTimer = 0;          // Closes the connection once it is idle for idleTimeout
+    TimerId requestTimer = 0;       // Closes the connection if a started request is not finished in time
+};
+
+map<int, Connection> connections;  // Open connections by fd
+unsigned long nextConnectionId = 1;  // Source of the connection ids
+size_t highWaterMark = 1024 * 1024;  // Stop reading a client once this much output is pending
+size_t lowWaterMark = 256 * 1024;  // Resume reading once the pending output drained to this
+const size_t MAX_LINE = 64 * 1024;  // Longest command line accepted
+uint64_t idleTimeout = 300 * 1000;  // Close a connection that neither sends nor receives for this long (ms), 0 = never
+uint64_t requestTimeout = 60 * 1000;  // Close a connection that leaves a request unfinished for this long (ms), 0 = never
+const uint64_t STATS_INTERVAL = 60 * 1000;  // How often the server statistics are printed (ms)
+unsigned long commandsHandled = 0;  // Lines handled since the start
+unsigned long long bytesSent = 0;  // Response bytes sent since the start
+
+void handleReadable(int fd);
+void handleWritable(int fd);
+
+// Function to get the number of response bytes still waiting for the socket
+size_t pendingOutput(const Connection& conn) {
+    return conn.output.size() - conn.outputSent;
+}
+
+// Function to close a connection and forget its state
+void closeConnection(int fd) {
+    Connection& conn = connections[fd];
+    if (conn.idleTimer) {
+        reactor.cancelTimer(conn.idleTimer);
+    }
+    if (conn.requestTimer) {
+        reactor.cancelTimer(conn.requestTimer);
+    }
+    if (conn.reading) {
+        reactor.removeFdFromReactor(fd);  // Stop watching the socket before it is closed
+    }
+    if (conn.writing) {
+        reactor.removeWriteFdFromReactor(fd);
+    }
+    close(fd);  // Close the client socket
+    connections.erase(fd);  // A running job finds no connection and drops its result
+}
+
+// Function to send as much pending output as the socket takes; returns false if the connection broke
+bool flushOutput(int fd, Connection& conn) {
+    while (pendingOutput(conn) > 0) {
+        ssize_t sent = send(fd, conn.output.data() + conn.outputSent, pendingOutput(conn), MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;  // The socket buffer is full, the rest goes out when it is writable again
+            }
+            perror("send");
+            return false;
         }
-        close(client_fd);  // Close the client socket
+        conn.outputSent += sent;
+        bytesSent += sent;
+        conn.lastActivity = reactor.now();
+    }
+    if (conn.outputSent == conn.output.size()) {
+        conn.output.clear();
+        conn.outputSent = 0;
+    } else if (conn.outputSent > conn.output.size() / 2) {
+        conn.output.erase(0, conn.outputSent);  // Compact now and then instead of on every send
+        conn.outputSent = 0;
+    }
+    return true;
+}
+
+// Function to check an idle connection when its timer fires; the timer is not reset on every byte,
+// instead it is re-armed here for whatever is left of the timeout
+void checkIdle(int fd, unsigned long id) {
+    auto it = connections.find(fd);
+    if (it == connections.end() || it->second.id != id) {
+        return;  // The connection is gone
+    }
+    Connection& conn = it->second;
+    uint64_t idle = reactor.now() - conn.lastActivity;
+    if (!conn.busy && idle >= idleTimeout) {
+        cout << "Socket " << fd << " idle for " << idle / 1000 << " s, closing" << endl;
+        conn.idleTimer = 0;  // It just fired
+        closeConnection(fd);
         return;
     }
-    buf[nbytes] = '\0';  // Null-terminate the buffer
-    string command(buf);  // Convert the buffer to a string
+    uint64_t delay = conn.busy ? idleTimeout : idleTimeout - idle;  // A running job is not idleness
+    conn.idleTimer = reactor.addTimer(delay, [fd, id] { checkIdle(fd, id); });
+}
+
+// Function to close a connection whose request was not finished in time
+void requestTimedOut(int fd, unsigned long id) {
+    auto it = connections.find(fd);
+    if (it == connections.end() || it->second.id != id) {
+        return;  // The connection is gone
+    }
+    cerr << "Socket " << fd << " did not finish its request within " << requestTimeout / 1000 << " s" << endl;
+    it->second.requestTimer = 0;  // It just fired
+    closeConnection(fd);
+}
+
+// Function to time the request the client has started but not finished: a partial line or the
+// edges of a "Newgraph"
+void updateRequestTimer(int fd, Connection& conn) {
+    if (requestTimeout == 0) {
+        return;
+    }
+    bool unfinished = conn.pendingEdges > 0 || (!conn.input.empty() && conn.input.find('\n') == string::npos);
+    if (unfinished && conn.requestTimer == 0) {
+        unsigned long id = conn.id;
+        conn.requestTimer = reactor.addTimer(requestTimeout, [fd, id] { requestTimedOut(fd, id); });
+    } else if (!unfinished && conn.requestTimer != 0) {
+        reactor.cancelTimer(conn.requestTimer);
+        conn.requestTimer = 0;
+    }
+}
+
+// Function to print the server statistics, run periodically on the reactor thread
+void printStats() {
+    cout << "Stats: " << connections.size() << " connections, " << commandsHandled << " commands, "
+         << bytesSent / 1024 << " KB sent, graph with " << n << " vertices and " << m << " edges" << endl;
+}
+
+// Function to install a graph received with "Newgraph"
+void finishNewGraph(Connection& conn) {
+    adj = conn.newGraph;  // Running jobs keep the old graph
+    pendingEdits.clear();  // They were edits of the old graph
+    graphVersion++;
+    n = conn.newVertices;  // Set the number of vertices
+    m = conn.newEdges;  // Set the number of edges
+    conn.newGraph.reset();
+    cout << "Graph with " << n << " vertices and " << m << " edges created." << endl;
+    conn.output += "New graph created.\n";
+}
+
+// Function to handle one edge line of a "Newgraph" command
+void handleEdgeLine(Connection& conn, const string& line) {
+    int u = 0, v = 0;
+    stringstream ss(line);  // Create a string stream from the line
+    ss >> u >> v;  // Parse the edge endpoints
+    if (u < 1 || u > conn.newVertices || v < 1 || v > conn.newVertices) {
+        cerr << "Invalid edge: " << u << " " << v << endl;
+        return;  // Wait for a valid edge instead
+    }
+    (*conn.newGraph)[u - 1].push_back(v - 1);  // Add the edge to the adjacency list
+    if (--conn.pendingEdges == 0) {
+        finishNewGraph(conn);
+    }
+}
+
+// Function to handle one command line of a client
+void handleCommand(int client_fd, Connection& conn, const string& command) {
     stringstream ss(command);  // Create a string stream from the command
     string cmd;  // String to store the parsed command
     ss >> cmd;  // Parse the command
     cmd = toLowerCase(cmd);  // Convert command to lowercase
-    string response;  // String to store the response
     if (cmd == "newgraph") {
-        int vertices, edges;
+        int vertices = 0, edges = 0;
         ss >> vertices >> edges;  // Parse the number of vertices and edges
-        response = "Send the edges.\n";
-        send(client_fd, response.c_str(), response.length(), 0);  // Send the response to the client
-        handleNewGraph(vertices, edges, client_fd);  // Handle the Newgraph command
-        response = "New graph created.\n";
-        send(client_fd, response.c_str(), response.length(), 0);  // Send the response to the client
+        conn.newVertices = max(vertices, 0);
+        conn.newEdges = max(edges, 0);
+        conn.pendingEdges = conn.newEdges;  // The next lines are edges
+        conn.newGraph = make_shared<AdjacencyList>(conn.newVertices);
+        conn.output += "Send the edges.\n";
+        if (conn.pendingEdges == 0) {
+            finishNewGraph(conn);
+        }
     } else if (cmd == "kosaraju") {
-        response = findSCCs();  // Find the SCCs
-        send(client_fd, response.c_str(), response.length(), 0);  // Send the response to the client
+        // Find the SCCs on a worker so the loop keeps serving the other clients
+        catchUpEdits();  // Saves the job a copy if no other job reads adj
+        shared_ptr<SCCJob> job = make_shared<SCCJob>();
+        job->graph = adj;  // Edits made meanwhile are logged, not applied to it
+        job->edits = pendingEdits;  // Edits this client may have made since adj was shared
+        job->version = graphVersion;
+        unsigned long id = conn.id;
+        conn.busy = true;  // Parse nothing more from this client until it has its answer
+        reactor.postWork([job] { runSCCJob(*job); },
+                         [client_fd, id, job] {
+                             finishSCCJob(*job);
+                             auto it = connections.find(client_fd);
+                             if (it == connections.end() || it->second.id != id) {
+                                 return;  // The client is gone
+                             }
+                             it->second.output += job->result;
+                             it->second.busy = false;
+                             handleWritable(client_fd);  // Send the answer and continue with queued commands
+                         });
     } else if (cmd == "newedge") {
-        int u, v;
+        int u = 0, v = 0;
         ss >> u >> v;  // Parse the edge endpoints
         handleNewEdge(u, v);  // Handle the Newedge command
-        response = "Edge added.\n";
-        send(client_fd, response.c_str(), response.length(), 0);  // Send the response to the client
+        conn.output += "Edge added.\n";
     } else if (cmd == "removeedge") {
-        int u, v;
+        int u = 0, v = 0;
         ss >> u >> v;  // Parse the edge endpoints
         handleRemoveEdge(u, v);  // Handle the Removeedge command
-        response = "Edge removed.\n";
-        send(client_fd, response.c_str(), response.length(), 0);  // Send the response to the client
+        conn.output += "Edge removed.\n";
     } else {
-        response = "Invalid command.\n";
-        send(client_fd, response.c_str(), response.length(), 0);  // Send an error message for invalid commands
+        conn.output += "Invalid command.\n";  // Send an error message for invalid commands
+    }
+}
+
+// Function to bring a connection up to date: run complete lines, send pending output, and
+// adjust what the reactor watches. Returns false if the connection was closed.
+bool serviceConnection(int fd) {
+    Connection& conn = connections[fd];
+    size_t start = 0, end;
+    while (true) {
+        if (!flushOutput(fd, conn)) {
+            closeConnection(fd);
+            return false;
+        }
+        if (conn.busy || pendingOutput(conn) > highWaterMark ||
+            (end = conn.input.find('\n', start)) == string::npos) {
+            break;  // Waiting for a job, for the client to drain its responses, or for more input
+        }
+        string line = conn.input.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);  // Telnet ends lines with \r\n
+        }
+        if (conn.pendingEdges > 0) {
+            handleEdgeLine(conn, line);
+        } else {
+            handleCommand(fd, conn, line);
+        }
+        ++commandsHandled;
+    }
+    conn.input.erase(0, start);
+    if (conn.input.size() > MAX_LINE && conn.input.find('\n') == string::npos) {
+        cerr << "Socket " << fd << " sent a line longer than " << MAX_LINE << " bytes" << endl;
+        closeConnection(fd);
+        return false;
+    }
+    updateRequestTimer(fd, conn);
+
+    bool wantWrite = pendingOutput(conn) > 0;  // Watch for writability only while output is pending
+    if (wantWrite != conn.writing) {
+        if (wantWrite) {
+            reactor.addWriteFdToReactor(fd, handleWritable);
+        } else {
+            reactor.removeWriteFdFromReactor(fd);
+        }
+        conn.writing = wantWrite;
+    }
+    // Stop reading above the high-water mark and resume below the low-water mark, so a client that
+    // does not drain its responses is held back by TCP flow control instead of our memory
+    bool wantRead = !conn.busy && pendingOutput(conn) <= (conn.reading ? highWaterMark : lowWaterMark);
+    if (wantRead != conn.reading) {
+        if (wantRead) {
+            reactor.addFdToReactor(fd, handleReadable);
+        } else {
+            reactor.removeFdFromReactor(fd);
+        }
+        conn.reading = wantRead;
+    }
+    return true;
+}
+
+// Function to handle a client socket that has data to read
+void handleReadable(int fd) {
+    auto it = connections.find(fd);
+    if (it == connections.end()) {
+        return;
+    }
+    char buf[64 * 1024];  // Buffer to store received data
+    ssize_t nbytes = recv(fd, buf, sizeof(buf), 0);  // Receive data from the client
+    if (nbytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return;  // Nothing there after all
+    }
+    if (nbytes <= 0) {
+        if (nbytes == 0) {
+            cout << "Socket " << fd << " hung up" << endl;
+        } else {
+            perror("recv");
+        }
+        closeConnection(fd);
+        return;
+    }
+    it->second.input.append(buf, nbytes);
+    it->second.lastActivity = reactor.now();
+    serviceConnection(fd);
+}
+
+// Function to handle a client socket that can take more output
+void handleWritable(int fd) {
+    if (connections.count(fd)) {
+        serviceConnection(fd);
     }
 }
 
 // Main function
-int main() {
+int main(int argc, char* argv[]) {
     int listener;  // Listening socket descriptor
     struct sockaddr_in myaddr;  // Server address
     int yes = 1;  // For setsockopt() SO_REUSEADDR, below
     int port = 9034;  // Port number
 
+    if (argc > 1) {
+        highWaterMark = strtoul(argv[1], nullptr, 10) * 1024;  // High-water mark in KB
+    }
+    if (argc > 2) {
+        lowWaterMark = strtoul(argv[2], nullptr, 10) * 1024;  // Low-water mark in KB
+    }
+    if (argc > 3) {
+        idleTimeout = strtoull(argv[3], nullptr, 10) * 1000;  // Idle timeout in seconds
+    }
+    if (argc > 4) {
+        requestTimeout = strtoull(argv[4], nullptr, 10) * 1000;  // Request timeout in seconds
+    }
+    lowWaterMark = min(lowWaterMark, highWaterMark);
+
+    // Block the stop signals before any thread starts, the threads inherit the mask
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+
     // Create a socket
     if ((listener = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
         perror("socket");
@@ -237,8 +509,7 @@ int main() {
         exit(1);
     }
 
-    Reactor reactor;  // Create a reactor
-    reactor.startReactor();  // Start the reactor
+    reactor.startWorkers(max(1u, thread::hardware_concurrency()));  // Threads for the SCC computations
     reactor.addFdToReactor(listener, [&](int fd) {
         struct sockaddr_in remoteaddr;  // Client address
         socklen_t addrlen = sizeof(remoteaddr);
@@ -248,16 +519,32 @@ int main() {
         } else {
             cout << "New connection from "
                  << inet_ntoa(remoteaddr.sin_addr) << " on socket " << newfd << endl;
-            reactor.addFdToReactor(newfd, handleClient);  // Add the new client to the reactor
+            fcntl(newfd, F_SETFL, fcntl(newfd, F_GETFL, 0) | O_NONBLOCK);  // Never block the loop on this client
+            Connection& conn = connections[newfd];
+            conn = Connection();
+            conn.id = nextConnectionId++;
+            conn.reading = true;
+            conn.lastActivity = reactor.now();
+            if (idleTimeout != 0) {
+                unsigned long id = conn.id;
+                conn.idleTimer = reactor.addTimer(idleTimeout, [newfd, id] { checkIdle(newfd, id); });
+            }
+            reactor.addFdToReactor(newfd, handleReadable);  // Add the new client to the reactor
         }
     });
+    reactor.addPeriodicTimer(STATS_INTERVAL, printStats);
+    reactor.startReactor();  // Start the reactor, registrations from now on are applied by its loop
 
-    // Keep the server running indefinitely
-    while (true) {
-        std::this_thread::sleep_for(std::chrono::minutes(10));  // Sleep to keep the main thread running
-    }
+    // Wait for Ctrl-C or kill; the signals are blocked in all threads so only sigwait() sees them
+    int sig;
+    sigwait(&stopSignals, &sig);
+    cout << "Signal " << sig << " received, shutting down" << endl;
 
-    reactor.stopReactor();  // Stop the reactor (unreachable code in this case)
+    reactor.stopReactor();  // Wake the loop and wait for it to exit
+    for (auto& entry : connections) {  // The loop is gone, nothing else touches the connections now
+        close(entry.first);
+    }
+    connections.clear();
     close(listener);  // Close the listening socket
     return 0;
 }
\ No newline at end of file
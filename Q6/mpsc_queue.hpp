@@ -0,0 +1,60 @@
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <utility>
+
+// Lock-free multi-producer single-consumer queue (linked list with a stub node).
+// push() may be called from any thread; pop() and empty() only from the single consumer.
+template <typename T>
+class MPSCQueue {
+public:
+    MPSCQueue() : head(new Node()), tail(head.load()) {}
+
+    ~MPSCQueue() {
+        T value;
+        while (pop(value)) {}  // Free the queued nodes
+        delete tail;  // And the stub
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    // Appends a value; one atomic exchange, never blocks
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);  // Claim the end of the list
+        prev->next.store(node, std::memory_order_seq_cst);  // Link it; the consumer can see it from now on
+    }
+
+    // Takes the oldest value; returns false if the queue is empty
+    bool pop(T& value) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        value = std::move(next->value);
+        delete tail;  // The old stub is done, next becomes the new stub
+        tail = next;
+        return true;
+    }
+
+    // Checks whether there is nothing to pop
+    bool empty() const {
+        return tail->next.load(std::memory_order_seq_cst) == nullptr;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next;
+        T value;
+
+        Node() : next(nullptr), value() {}
+        explicit Node(T v) : next(nullptr), value(std::move(v)) {}
+    };
+
+    std::atomic<Node*> head;  // Last node, shared by the producers
+    Node* tail;               // Stub before the oldest value, owned by the consumer
+};
+
+#endif // MPSC_QUEUE_HPP
@@ -2,14 +2,32 @@
 #define REACTOR_HPP
 
 #include <sys/select.h>
-#include <map>
 #include <functional>
+#include <deque>
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include <unistd.h>
+#include "mpsc_queue.hpp"
+#include "timer_wheel.hpp"
+#include "fd_handler.hpp"
 
-// Type definition for the reactor function callback
-typedef std::function<void(int)> reactorFunc;
+// Type definition for the reactor function callback; takes any callable void(int), stored without
+// a heap allocation when it is small
+typedef FdHandler reactorFunc;
 
-// Reactor class definition
+// Type definition for work posted to the worker pool and for its completion
+typedef std::function<void()> workFunc;
+
+// Reactor class definition.
+// The fd methods may be called from any thread. Calls from the reactor thread (the callbacks) take
+// effect immediately, calls from other threads are queued and applied by the loop after a wakeup.
+// The timer methods belong to the reactor thread (or to the time before startReactor()); other
+// threads reach it with runInLoop().
 class Reactor {
 public:
     Reactor();  // Constructor
@@ -24,18 +42,107 @@ public:
     // Removes a file descriptor from the reactor
     int removeFdFromReactor(int fd);
 
-    // Stops the reactor
+    // Watches a file descriptor for writability with the specified callback function
+    int addWriteFdToReactor(int fd, reactorFunc func);
+
+    // Stops watching a file descriptor for writability
+    int removeWriteFdFromReactor(int fd);
+
+    // Stops the reactor and waits for its loop to exit (unless called from the loop itself)
     int stopReactor();
 
+    // Starts the worker threads that run posted work
+    int startWorkers(unsigned threads);
+
+    // Runs work on a worker thread, then its completion on the reactor thread
+    int postWork(workFunc work, workFunc completion);
+
+    // Runs a function on the reactor thread
+    int runInLoop(workFunc task);
+
+    // Runs a function on the reactor thread once, after delayMs milliseconds
+    TimerId addTimer(uint64_t delayMs, workFunc callback);
+
+    // Runs a function on the reactor thread every periodMs milliseconds
+    TimerId addPeriodicTimer(uint64_t periodMs, workFunc callback);
+
+    // Cancels a timer; returns -1 if it already fired or was cancelled
+    int cancelTimer(TimerId id);
+
+    // Returns the milliseconds since the reactor was created, the clock of the timers
+    uint64_t now() const;
+
 private:
+    // A change requested from another thread, applied by the loop
+    struct Command {
+        enum Type { ADD_READ, REMOVE_READ, ADD_WRITE, REMOVE_WRITE, RUN };
+        Type type = RUN;
+        int fd = -1;
+        reactorFunc func;  // Callback for ADD_READ and ADD_WRITE
+        workFunc task;     // Function to run on the loop for RUN
+    };
+
     fd_set masterSet;  // Master set of file descriptors
     fd_set readSet;    // Temporary set of file descriptors for select()
+    fd_set writeMasterSet;  // Master set of file descriptors watched for writability
+    fd_set writeSet;   // Temporary set of writable file descriptors for select()
     int fdMax;         // Maximum file descriptor number
-    bool running;      // Flag indicating if the reactor is running
-    std::map<int, reactorFunc> callbacks;  // Map of file descriptors to their callback functions
+    std::atomic<bool> running;  // Flag indicating if the reactor is running
+
+    // Callbacks of one file descriptor
+    struct FdSlot {
+        reactorFunc read;   // Called when the fd is readable
+        reactorFunc write;  // Called when the fd is writable
+    };
+    std::vector<FdSlot> handlers;  // Callbacks indexed by fd, FD_SETSIZE of them so they never move
+
+    // A callback that removes or replaces itself keeps running; the change is applied after it returns
+    int dispatchFd;  // Fd whose callback is running, -1 outside of a callback
+    reactorFunc FdSlot::*dispatchWhich;  // Which callback of dispatchFd is running
+    bool dispatchChanged;  // The running callback was removed or replaced
+    reactorFunc dispatchReplacement;  // What replaces it (empty if it was removed)
+
+    int wakeupFd;  // eventfd that wakes the loop out of select()
+    MPSCQueue<Command> commands;  // Changes from other threads, drained by the loop
+    std::atomic<bool> started;  // Set once other threads must go through the command queue
+    std::atomic<std::thread::id> loopId;  // Id of the reactor thread
+    std::thread loopThread;  // The reactor thread
+
+    TimerWheel timers;  // Pending timers (reactor thread only)
+    std::chrono::steady_clock::time_point startTime;  // Tick 0 of the timers
+
+    std::vector<std::thread> workers;  // Worker threads
+    std::deque<std::pair<workFunc, workFunc>> workQueue;  // Posted work and its completion
+    bool stopping;  // Tells the workers to exit
+    std::mutex workMutex;  // Protects workQueue and stopping
+    std::condition_variable workCond;  // Signaled when work is posted or the workers must exit
 
     // Main loop of the reactor
     void run();
+
+    // Main loop of a worker thread
+    void workerLoop();
+
+    // Checks whether a change can be applied directly instead of being queued
+    bool onLoopThread() const;
+
+    // Queues a change for the loop and wakes it up
+    void submit(Command command);
+
+    // Wakes the loop out of select()
+    void wakeup();
+
+    // Applies the queued changes (reactor thread only)
+    void drainCommands(int fd);
+
+    // Applies one change (reactor thread only)
+    void apply(Command& command);
+
+    // Stores or removes a callback, deferred if it is the one running (reactor thread only)
+    void setHandler(int fd, reactorFunc FdSlot::*which, reactorFunc func);
+
+    // Calls the read or write callback of a ready fd (reactor thread only)
+    void dispatch(int fd, reactorFunc FdSlot::*which);
 };
 
 #endif // REACTOR_HPP
@@ -0,0 +1,183 @@
+#include "timer_wheel.hpp"
+#include <algorithm>
+#include <utility>
+
+// Constructor creates empty slots on all levels
+TimerWheel::TimerWheel() : heads(LEVELS * SLOTS, -1), current(0), active(0) {
+    std::fill(levelCount, levelCount + LEVELS, 0);
+}
+
+// Adds a timer that fires at tick expires (and then every period ticks, if period is not 0)
+TimerId TimerWheel::add(uint64_t expires, uint64_t period, timerFunc callback) {
+    int index;
+    if (!freeNodes.empty()) {  // Reuse a node, the vector only grows to the peak number of timers
+        index = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        index = nodes.size();
+        nodes.push_back(Node());
+    }
+    Node& node = nodes[index];
+    node.expires = std::max(expires, current + 1);  // The current tick is already processed
+    node.period = period;
+    node.callback = std::move(callback);
+    link(index);
+    ++active;
+    return (static_cast<uint64_t>(node.generation) << 32) | static_cast<uint64_t>(index + 1);
+}
+
+// Cancels a timer; returns false if it already fired (one-shot) or was cancelled
+bool TimerWheel::cancel(TimerId id) {
+    int index = find(id);
+    if (index == -1) {
+        return false;
+    }
+    unlink(index);
+    release(index);
+    --active;
+    return true;
+}
+
+// Fires every timer due at or before tick now
+void TimerWheel::expire(uint64_t now) {
+    while (current < now) {
+        if (active == 0) {
+            current = now;  // Nothing to fire, skip the idle ticks
+            break;
+        }
+        uint64_t tick = ++current;
+
+        // Higher levels first, their timers may land in the lower slot that is cascaded next
+        for (int level = LEVELS - 1; level > 0; --level) {
+            int shift = level * SLOT_BITS;
+            if ((tick & ((uint64_t(1) << shift) - 1)) == 0) {
+                cascade(level, (tick >> shift) & (SLOTS - 1));
+            }
+        }
+
+        int slot = tick & (SLOTS - 1);
+        while (heads[slot] != -1) {  // Take one at a time, a callback may cancel the others
+            int index = heads[slot];
+            unlink(index);
+            Node& node = nodes[index];
+            if (node.period != 0) {
+                timerFunc callback = node.callback;  // The node stays pending, keep its callback
+                node.expires = std::max(node.expires + node.period, current + 1);
+                link(index);
+                callback();
+            } else {
+                timerFunc callback = std::move(node.callback);
+                release(index);
+                --active;
+                callback();  // After the release, so the callback may add timers that reuse the node
+            }
+        }
+    }
+}
+
+// Returns the ticks after now when expire() has work to do, or -1 if there are no timers
+int64_t TimerWheel::nextTimeout(uint64_t now) const {
+    if (active == 0) {
+        return -1;
+    }
+    uint64_t next = UINT64_MAX;
+    if (levelCount[0] > 0) {
+        for (int k = 1; k < SLOTS; ++k) {  // Level 0 holds the next SLOTS - 1 ticks
+            if (heads[(current + k) & (SLOTS - 1)] != -1) {
+                next = current + k;
+                break;
+            }
+        }
+    }
+    for (int level = 1; level < LEVELS; ++level) {
+        if (levelCount[level] == 0) {
+            continue;
+        }
+        int shift = level * SLOT_BITS;
+        for (int k = 1; k <= SLOTS; ++k) {  // Wake up to cascade the first slot that is not empty
+            uint64_t tick = ((current >> shift) + k) << shift;
+            if (tick >= next) {
+                break;
+            }
+            if (heads[level * SLOTS + ((tick >> shift) & (SLOTS - 1))] != -1) {
+                next = tick;
+                break;
+            }
+        }
+    }
+    return next <= now ? 0 : static_cast<int64_t>(next - now);
+}
+
+// Links a node into the slot for its expiry, relative to current
+void TimerWheel::link(int index) {
+    Node& node = nodes[index];
+    uint64_t expires = std::max(node.expires, current);  // Cascaded timers may be due right now
+    uint64_t delta = expires - current;
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (uint64_t(1) << ((level + 1) * SLOT_BITS))) {
+        ++level;
+    }
+    uint64_t range = uint64_t(1) << (LEVELS * SLOT_BITS);
+    if (delta >= range) {
+        expires = current + range - 1;  // Beyond the wheel; parked in the last slot and re-linked on cascade
+    }
+    int slot = level * SLOTS + ((expires >> (level * SLOT_BITS)) & (SLOTS - 1));
+
+    node.slot = slot;
+    node.prev = -1;
+    node.next = heads[slot];
+    if (node.next != -1) {
+        nodes[node.next].prev = index;
+    }
+    heads[slot] = index;
+    ++levelCount[level];
+}
+
+// Unlinks a node from its slot
+void TimerWheel::unlink(int index) {
+    Node& node = nodes[index];
+    if (node.prev != -1) {
+        nodes[node.prev].next = node.next;
+    } else {
+        heads[node.slot] = node.next;
+    }
+    if (node.next != -1) {
+        nodes[node.next].prev = node.prev;
+    }
+    --levelCount[node.slot / SLOTS];
+    node.prev = node.next = -1;
+}
+
+// Frees a node and invalidates its handle
+void TimerWheel::release(int index) {
+    Node& node = nodes[index];
+    node.slot = -1;
+    node.callback = nullptr;
+    ++node.generation;
+    freeNodes.push_back(index);
+}
+
+// Moves the timers of one slot of a higher level to the lower levels
+void TimerWheel::cascade(int level, int slot) {
+    int index = heads[level * SLOTS + slot];
+    heads[level * SLOTS + slot] = -1;
+    while (index != -1) {
+        int next = nodes[index].next;
+        --levelCount[level];
+        link(index);  // Due within this slot's span, so it lands on a lower level (unless beyond the wheel)
+        index = next;
+    }
+}
+
+// Finds the node of a handle, or -1 if the handle is stale
+int TimerWheel::find(TimerId id) const {
+    uint64_t index = (id & 0xffffffffu);
+    if (index == 0 || index > nodes.size()) {
+        return -1;
+    }
+    const Node& node = nodes[index - 1];
+    if (node.slot == -1 || node.generation != static_cast<uint32_t>(id >> 32)) {
+        return -1;
+    }
+    return index - 1;
+}
@@ -0,0 +1,76 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Type definition for the function a timer runs when it fires
+typedef std::function<void()> timerFunc;
+
+// Handle of a timer; 0 is never a valid handle
+typedef uint64_t TimerId;
+
+// Hierarchical timer wheel: LEVELS levels of SLOTS slots, one tick per millisecond.
+// Adding, cancelling and firing a timer are O(1); a timer far in the future moves down one level
+// at a time, so it is touched at most LEVELS times. Not thread-safe, the reactor uses it from its loop.
+class TimerWheel {
+public:
+    TimerWheel();
+
+    // Adds a timer that fires at tick expires (and then every period ticks, if period is not 0)
+    TimerId add(uint64_t expires, uint64_t period, timerFunc callback);
+
+    // Cancels a timer; returns false if it already fired (one-shot) or was cancelled
+    bool cancel(TimerId id);
+
+    // Fires every timer due at or before tick now
+    void expire(uint64_t now);
+
+    // Returns the ticks after now when expire() has work to do, or -1 if there are no timers
+    int64_t nextTimeout(uint64_t now) const;
+
+    // Returns the number of pending timers
+    size_t size() const { return active; }
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+
+    // A timer; the nodes live in one vector and link to each other by index
+    struct Node {
+        uint64_t expires = 0;   // Tick the timer fires at
+        uint64_t period = 0;    // Ticks between firings of a periodic timer, 0 for a one-shot
+        timerFunc callback;
+        uint32_t generation = 0;  // Bumped when the node is reused, so stale handles do not match
+        int slot = -1;          // Slot the node is linked into, -1 if it is free
+        int prev = -1;
+        int next = -1;
+    };
+
+    std::vector<Node> nodes;     // All nodes, pending and free
+    std::vector<int> freeNodes;  // Indexes of the free nodes
+    std::vector<int> heads;      // First node of every slot, LEVELS * SLOTS of them
+    int levelCount[LEVELS];      // Pending timers per level, to skip empty levels
+    uint64_t current;            // Last tick that was processed
+    size_t active;               // Pending timers
+
+    // Links a node into the slot for its expiry, relative to current
+    void link(int index);
+
+    // Unlinks a node from its slot
+    void unlink(int index);
+
+    // Frees a node and invalidates its handle
+    void release(int index);
+
+    // Moves the timers of one slot of a higher level to the lower levels
+    void cascade(int level, int slot);
+
+    // Finds the node of a handle, or -1 if the handle is stale
+    int find(TimerId id) const;
+};
+
+#endif // TIMER_WHEEL_HPP
@@ -0,0 +1,126 @@
+#include "async_logger.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Lines the ring holds; a burst beyond this is dropped instead of blocking the client threads
+static const size_t RING_SIZE = 8192;
+
+// One log line in the ring
+struct LogCell {
+    atomic<size_t> sequence{0}; // Position the cell is ready for, see pushLine() and popLine()
+    bool error = false;      // stderr instead of stdout
+    string text;
+};
+
+static vector<LogCell> ring(RING_SIZE); // Bounded multi-producer single-consumer ring
+static atomic<size_t> enqueuePos(0); // Next position producers claim
+static size_t dequeuePos = 0; // Next position the logger thread reads (logger thread only)
+static atomic<uint64_t> dropped(0); // Lines lost to a full ring
+
+static atomic<bool> loggerSleeping(false); // Set while the logger waits for lines
+static mutex loggerMutex; // Only used to park and wake the logger
+static condition_variable loggerCond;
+
+// Function to put a line into the ring; returns false if the ring is full
+static bool pushLine(bool error, const string& text) {
+    size_t pos = enqueuePos.load(memory_order_relaxed);
+    LogCell* cell;
+    while (true) {
+        cell = &ring[pos % RING_SIZE];
+        size_t sequence = cell->sequence.load(memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                break; // The cell is ours
+            }
+        } else if (diff < 0) {
+            return false; // The logger has not read this cell yet: the ring is full
+        } else {
+            pos = enqueuePos.load(memory_order_relaxed); // Another producer took it, try the next one
+        }
+    }
+    cell->error = error;
+    cell->text = text;
+    cell->sequence.store(pos + 1); // Hand the cell to the logger; seq_cst, it pairs with loggerSleeping
+    return true;
+}
+
+// Function to take the oldest line out of the ring (logger thread only); returns false if it is empty
+static bool popLine(bool& error, string& text) {
+    LogCell& cell = ring[dequeuePos % RING_SIZE];
+    if (cell.sequence.load(memory_order_acquire) != dequeuePos + 1) {
+        return false;
+    }
+    error = cell.error;
+    text.swap(cell.text);
+    cell.sequence.store(dequeuePos + RING_SIZE, memory_order_release); // Free for the next lap
+    ++dequeuePos;
+    return true;
+}
+
+// Function to queue a line and wake the logger if it is parked
+static void logLine(bool error, const string& line) {
+    if (!pushLine(error, line)) {
+        dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    if (loggerSleeping.load()) { // Rare path: the logger is parked and needs a wakeup
+        lock_guard<mutex> lock(loggerMutex);
+        loggerCond.notify_one();
+    }
+}
+
+// Function to check whether a line is waiting (logger thread only)
+static bool lineWaiting() {
+    return ring[dequeuePos % RING_SIZE].sequence.load() == dequeuePos + 1;
+}
+
+// Function run by the logger thread: write lines as they come, flush when the ring runs dry
+static void loggerLoop() {
+    bool error;
+    string text;
+    while (true) {
+        while (popLine(error, text)) {
+            FILE* stream = error ? stderr : stdout;
+            fputs(text.c_str(), stream);
+            fputc('\n', stream);
+        }
+        fflush(stdout); // One flush per burst instead of one per line
+
+        unique_lock<mutex> lock(loggerMutex);
+        loggerSleeping.store(true);
+        loggerCond.wait(lock, [] { return lineWaiting(); });
+        loggerSleeping.store(false);
+    }
+}
+
+// Function to start the thread that writes the log lines to stdout and stderr
+void startLogger() {
+    for (size_t i = 0; i < RING_SIZE; ++i) {
+        ring[i].sequence.store(i); // Every cell is free for the first lap
+    }
+    thread logger(loggerLoop);
+    logger.detach(); // The logger lives as long as the server
+}
+
+// Function to log a line to stdout without waiting for it; the line is dropped if the ring is full
+void logInfo(const string& line) {
+    logLine(false, line);
+}
+
+// Function to log a line to stderr without waiting for it; the line is dropped if the ring is full
+void logError(const string& line) {
+    logLine(true, line);
+}
+
+// Function to get the number of lines dropped because the ring was full
+uint64_t droppedLogLines() {
+    return dropped.load(memory_order_relaxed);
+}
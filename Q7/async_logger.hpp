@@ -0,0 +1,19 @@
+#ifndef ASYNC_LOGGER_HPP
+#define ASYNC_LOGGER_HPP
+
+#include <cstdint>
+#include <string>
+
+// Function to start the thread that writes the log lines to stdout and stderr
+void startLogger();
+
+// Function to log a line to stdout without waiting for it; the line is dropped if the ring is full
+void logInfo(const std::string& line);
+
+// Function to log a line to stderr without waiting for it; the line is dropped if the ring is full
+void logError(const std::string& line);
+
+// Function to get the number of lines dropped because the ring was full
+uint64_t droppedLogLines();
+
+#endif // ASYNC_LOGGER_HPP
@@ -0,0 +1,207 @@
+#include "compute_jobs.hpp"
+#include "graph_registry.hpp"
+#include "metrics.hpp"
+#include "async_logger.hpp"
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <thread>
+#include <sys/socket.h>
+
+using namespace std;
+
+// An asynchronous "Kosaraju" request
+struct SCCJob {
+    enum State { QUEUED, RUNNING, DONE, CANCELLED, FAILED };
+    int id = 0;
+    shared_ptr<GraphState> graph;              // Graph to run on, copied when the job starts
+    shared_ptr<ClientConnection> connection;   // Client that gets the result
+    SCCProgress progress;                      // Progress and cancellation of the run
+    atomic<int> state{QUEUED};
+    atomic<int> vertices{0};                   // Vertices of the snapshot, known once the job runs
+    atomic<int> sccCount{0};                   // Number of SCCs, known once the job is done
+};
+
+static map<int, shared_ptr<SCCJob>> jobs; // Jobs by id, kept until their result is sent or they are cancelled
+static queue<shared_ptr<SCCJob>> jobQueue; // Jobs waiting for a compute thread
+static int nextJobId = 1;
+static mutex jobsMutex; // Protects everything above
+static condition_variable jobCond; // Signaled when a job is queued
+
+// Function to send a whole response, unless the connection is already closed
+void sendResponse(ClientConnection& connection, const string& response) {
+    lock_guard<mutex> lock(connection.sendMutex);
+    if (connection.open) {
+        send(connection.fd, response.c_str(), response.length(), MSG_NOSIGNAL);
+        recordBytesOut(response.length());
+    }
+}
+
+// Function to forget a job whose result was delivered or that will never deliver one
+static void forgetJob(int id) {
+    lock_guard<mutex> lock(jobsMutex);
+    jobs.erase(id);
+}
+
+// Function to run one job on a private copy of its graph
+static void runJob(SCCJob& job) {
+    int expected = SCCJob::QUEUED;
+    if (!job.state.compare_exchange_strong(expected, SCCJob::RUNNING)) {
+        return; // Cancelled while it was queued, and already forgotten
+    }
+
+    vector<vector<int>> sccs;
+    {
+        GraphState snapshot; // The graph itself stays free for the writer and other queries
+        {
+            lock_guard<mutex> lock(job.graph->mutex);
+            if (!loadGraph(*job.graph)) {
+                job.state = SCCJob::FAILED;
+                sendResponse(*job.connection, "Job " + to_string(job.id) + " failed: graph " + job.graph->name +
+                                              " could not be loaded.\n");
+                forgetJob(job.id);
+                return;
+            }
+            snapshot.name = job.graph->name;
+            snapshot.n = job.graph->n;
+            snapshot.m = job.graph->m;
+            snapshot.adj = job.graph->adj;
+            snapshot.version = job.graph->version.load();
+        }
+        // The copy and the transpose computeSCCs builds on it count against the budget while the job runs
+        updateMemory(snapshot);
+        size_t reserved = snapshot.memoryBytes + (static_cast<size_t>(snapshot.n) + 1 + snapshot.m) * sizeof(int);
+        reserveJobMemory(reserved);
+        enforceMemoryBudget(); // Loading an evicted graph or the copy may have pushed the others over the budget
+        job.vertices = snapshot.n;
+
+        sccs = computeSCCs(snapshot, &job.progress);
+        releaseJobMemory(reserved); // The snapshot is freed at the end of this block
+        if (!job.progress.cancelled) {
+            lock_guard<mutex> lock(job.graph->mutex);
+            if (job.graph->version == snapshot.version) {
+                job.graph->trimStats = snapshot.trimStats; // "Graphs" reports the trimming of async runs too
+            }
+        }
+    }
+    if (job.progress.cancelled) {
+        job.state = SCCJob::CANCELLED;
+        logInfo("Job " + to_string(job.id) + " cancelled");
+        forgetJob(job.id);
+        return;
+    }
+    job.sccCount = sccs.size();
+    job.state = SCCJob::DONE;
+    sendResponse(*job.connection, "Job " + to_string(job.id) + " result:\n" + formatSCCs(sccs));
+    forgetJob(job.id); // Status and Cancel only matter until the result arrives
+}
+
+// Function run by every compute thread
+static void computeWorker() {
+    while (true) {
+        shared_ptr<SCCJob> job;
+        {
+            unique_lock<mutex> lock(jobsMutex);
+            jobCond.wait(lock, [] { return !jobQueue.empty(); });
+            job = jobQueue.front();
+            jobQueue.pop();
+        }
+        runJob(*job);
+    }
+}
+
+// Function to start the compute pool that runs asynchronous Kosaraju jobs
+void startComputePool(unsigned threads) {
+    for (unsigned i = 0; i < threads; ++i) {
+        thread worker(computeWorker);
+        worker.detach(); // The pool lives as long as the server
+    }
+}
+
+// Function to queue a Kosaraju job for a graph and return its id
+int submitSCCJob(const shared_ptr<GraphState>& graph, const shared_ptr<ClientConnection>& connection) {
+    shared_ptr<SCCJob> job = make_shared<SCCJob>();
+    job->graph = graph;
+    job->connection = connection;
+    {
+        lock_guard<mutex> lock(jobsMutex);
+        job->id = nextJobId++;
+        jobs[job->id] = job;
+        jobQueue.push(job);
+    }
+    jobCond.notify_one();
+    return job->id;
+}
+
+// Function to find a job of this client (jobsMutex held)
+static shared_ptr<SCCJob> findJob(int id, const ClientConnection& connection) {
+    auto it = jobs.find(id);
+    if (it == jobs.end() || it->second->connection.get() != &connection) {
+        return nullptr; // Other clients' jobs are invisible
+    }
+    return it->second;
+}
+
+// Function to handle the "Status" command
+string jobStatus(int id, const ClientConnection& connection) {
+    lock_guard<mutex> lock(jobsMutex);
+    shared_ptr<SCCJob> job = findJob(id, connection);
+    if (!job) {
+        return "No such job.\n";
+    }
+    string prefix = "Job " + to_string(id);
+    if (job->state != SCCJob::DONE && job->progress.cancelled) {
+        return prefix + " cancelled.\n"; // Still unwinding
+    }
+    switch (job->state.load()) {
+        case SCCJob::QUEUED:
+            return prefix + " queued.\n";
+        case SCCJob::RUNNING: {
+            int phase = job->progress.phase;
+            const char* phaseName = phase == SCCProgress::TRIMMING ? "trimming" :
+                                    phase == SCCProgress::FIRST_PASS ? "first pass" : "second pass";
+            return prefix + " running (" + phaseName + "): " + to_string(job->progress.finished.load()) + " of " +
+                   to_string(job->vertices.load()) + " vertices finished.\n";
+        }
+        case SCCJob::DONE:
+            return prefix + " done: " + to_string(job->sccCount.load()) + " SCCs.\n";
+        case SCCJob::FAILED:
+            return prefix + " failed: graph could not be loaded.\n";
+        default:
+            return prefix + " cancelled.\n";
+    }
+}
+
+// Function to handle the "Cancel" command
+string cancelJob(int id, const ClientConnection& connection) {
+    lock_guard<mutex> lock(jobsMutex);
+    shared_ptr<SCCJob> job = findJob(id, connection);
+    if (!job) {
+        return "No such job.\n";
+    }
+    if (job->state == SCCJob::DONE || job->state == SCCJob::FAILED) {
+        return "Job " + to_string(id) + " already finished.\n";
+    }
+    job->progress.cancelled = true; // A running job notices at its next vertex
+    int expected = SCCJob::QUEUED;
+    if (job->state.compare_exchange_strong(expected, SCCJob::CANCELLED)) {
+        jobs.erase(id); // A queued job never starts; a running one is forgotten once it unwinds
+    }
+    return "Job " + to_string(id) + " cancelled.\n";
+}
+
+// Function to cancel and forget all jobs of a client that disconnected
+void dropClientJobs(const ClientConnection& connection) {
+    lock_guard<mutex> lock(jobsMutex);
+    for (auto it = jobs.begin(); it != jobs.end(); ) {
+        if (it->second->connection.get() == &connection) {
+            it->second->progress.cancelled = true;
+            int expected = SCCJob::QUEUED;
+            it->second->state.compare_exchange_strong(expected, SCCJob::CANCELLED);
+            it = jobs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef COMPUTE_JOBS_HPP
+#define COMPUTE_JOBS_HPP
+
+#include "kosaraju_server.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+
+// One client connection; the client thread and finished jobs both write to it
+struct ClientConnection {
+    int fd = -1;
+    std::mutex sendMutex;   // Keeps whole responses from interleaving
+    bool open = true;       // False once the client thread closed the socket (sendMutex held)
+};
+
+// Function to send a whole response, unless the connection is already closed
+void sendResponse(ClientConnection& connection, const std::string& response);
+
+// Function to start the compute pool that runs asynchronous Kosaraju jobs
+void startComputePool(unsigned threads);
+
+// Function to queue a Kosaraju job for a graph and return its id
+int submitSCCJob(const std::shared_ptr<GraphState>& graph, const std::shared_ptr<ClientConnection>& connection);
+
+// Function to handle the "Status" command
+std::string jobStatus(int id, const ClientConnection& connection);
+
+// Function to handle the "Cancel" command
+std::string cancelJob(int id, const ClientConnection& connection);
+
+// Function to cancel and forget all jobs of a client that disconnected
+void dropClientJobs(const ClientConnection& connection);
+
+#endif // COMPUTE_JOBS_HPP
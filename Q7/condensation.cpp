@@ -0,0 +1,166 @@
+#include "condensation.hpp"
+#include <algorithm>    // Include algorithms like sort and unique
+#include <climits>      // Include INT_MAX
+#include <queue>        // Include queue for the topological sort
+#include <sstream>      // Include string stream
+#include <utility>      // Include pair
+
+using namespace std;
+
+// Function to check whether the reachable interval of SCC 'to' lies inside the one of SCC 'from'
+static bool intervalContains(const Condensation& cond, int from, int to) {
+    return cond.low[from] <= cond.low[to] && cond.post[to] <= cond.post[from];
+}
+
+// Function to check whether SCC 'to' is a descendant of SCC 'from' in the DFS spanning tree
+static bool treeDescendant(const Condensation& cond, int from, int to) {
+    return cond.pre[from] <= cond.pre[to] && cond.post[to] <= cond.post[from];
+}
+
+// Function to build the condensation DAG and its index from the SCCs of the graph
+void buildCondensation(Condensation& cond, const vector<list<int>>& adj, const vector<vector<int>>& sccs) {
+    int c = sccs.size(); // Number of SCCs, i.e. DAG nodes
+    cond.comp.assign(adj.size(), -1);
+    cond.compSize.assign(c, 0);
+    for (int i = 0; i < c; ++i) { // Label every vertex with its SCC id
+        for (int vertex : sccs[i]) {
+            cond.comp[vertex] = i;
+        }
+        cond.compSize[i] = sccs[i].size();
+    }
+
+    // Collect the edges between different SCCs and remove duplicates
+    cond.dag.assign(c, vector<int>());
+    for (size_t v = 0; v < adj.size(); ++v) {
+        for (int neighbor : adj[v]) {
+            if (cond.comp[v] != cond.comp[neighbor]) {
+                cond.dag[cond.comp[v]].push_back(cond.comp[neighbor]);
+            }
+        }
+    }
+    cond.dagEdges = 0;
+    for (auto& row : cond.dag) {
+        sort(row.begin(), row.end());
+        row.erase(unique(row.begin(), row.end()), row.end());
+        cond.dagEdges += row.size();
+    }
+
+    // Topological levels with Kahn's algorithm: level = longest path from a source SCC
+    vector<int> indegree(c, 0);
+    for (const auto& row : cond.dag) {
+        for (int next : row) {
+            indegree[next]++;
+        }
+    }
+    vector<int> roots; // Source SCCs, the roots of the DFS spanning forest below
+    queue<int> ready;
+    for (int i = 0; i < c; ++i) {
+        if (indegree[i] == 0) {
+            ready.push(i);
+            roots.push_back(i);
+        }
+    }
+    cond.level.assign(c, 0);
+    while (!ready.empty()) {
+        int cur = ready.front();
+        ready.pop();
+        for (int next : cond.dag[cur]) {
+            cond.level[next] = max(cond.level[next], cond.level[cur] + 1);
+            if (--indegree[next] == 0) {
+                ready.push(next);
+            }
+        }
+    }
+
+    // Iterative DFS from the sources to assign tree intervals and the lowest reachable post number
+    cond.pre.assign(c, -1);
+    cond.post.assign(c, -1);
+    cond.low.assign(c, INT_MAX);
+    int preCounter = 0, postCounter = 0;
+    vector<pair<int, size_t>> stack; // SCC and index of the next child to visit
+    for (int root : roots) {
+        cond.pre[root] = preCounter++;
+        stack.push_back(make_pair(root, 0));
+        while (!stack.empty()) {
+            int cur = stack.back().first;
+            size_t& childIndex = stack.back().second;
+            if (childIndex < cond.dag[cur].size()) {
+                int next = cond.dag[cur][childIndex++];
+                if (cond.pre[next] == -1) { // Tree edge: descend
+                    cond.pre[next] = preCounter++;
+                    stack.push_back(make_pair(next, 0));
+                }
+            } else { // All children are finished, so their low values are final
+                cond.post[cur] = postCounter++;
+                cond.low[cur] = cond.post[cur];
+                for (int next : cond.dag[cur]) {
+                    cond.low[cur] = min(cond.low[cur], cond.low[next]);
+                }
+                stack.pop_back();
+            }
+        }
+    }
+
+    cond.mark.assign(c, 0);
+    cond.stamp = 0;
+    cond.valid = true;
+}
+
+// Function to check whether SCC 'from' can reach SCC 'to' using the index
+bool condensationReaches(Condensation& cond, int from, int to) {
+    if (from == to) {
+        return true;
+    }
+    if (cond.level[from] >= cond.level[to] || !intervalContains(cond, from, to)) {
+        return false; // Negative cut: the level or interval label rules reachability out
+    }
+    if (treeDescendant(cond, from, to)) {
+        return true; // Positive cut: 'to' hangs below 'from' in the spanning tree
+    }
+
+    // Fallback search over the DAG, pruned with the same labels
+    if (cond.stamp == INT_MAX) {
+        fill(cond.mark.begin(), cond.mark.end(), 0);
+        cond.stamp = 0;
+    }
+    int stamp = ++cond.stamp;
+    vector<int> stack(1, from);
+    cond.mark[from] = stamp;
+    while (!stack.empty()) {
+        int cur = stack.back();
+        stack.pop_back();
+        for (int next : cond.dag[cur]) {
+            if (next == to || treeDescendant(cond, next, to)) {
+                return true;
+            }
+            if (cond.mark[next] == stamp || cond.level[next] >= cond.level[to] || !intervalContains(cond, next, to)) {
+                continue;
+            }
+            cond.mark[next] = stamp;
+            stack.push_back(next);
+        }
+    }
+    return false;
+}
+
+// Function to format the condensation DAG as a response for the client
+string formatCondensation(const Condensation& cond) {
+    int depth = 0;
+    for (int l : cond.level) {
+        depth = max(depth, l + 1);
+    }
+    stringstream ss;
+    ss << "Condensation DAG: " << cond.dag.size() << " SCCs, " << cond.dagEdges << " edges, "
+       << depth << " levels" << endl;
+    for (size_t i = 0; i < cond.dag.size(); ++i) {
+        if (cond.dag[i].empty()) {
+            continue;
+        }
+        ss << "SCC " << (i + 1) << " ->";
+        for (int next : cond.dag[i]) {
+            ss << " " << (next + 1);
+        }
+        ss << endl;
+    }
+    return ss.str();
+}
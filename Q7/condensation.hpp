@@ -0,0 +1,33 @@
+#ifndef CONDENSATION_HPP
+#define CONDENSATION_HPP
+
+#include <vector>
+#include <list>
+#include <string>
+
+// Condensation DAG of a graph together with a reachability index over it.
+// Every SCC becomes one DAG node, numbered in the order Kosaraju reports the SCCs.
+struct Condensation {
+    bool valid = false;                    // False until built, and again after any graph change
+    std::vector<int> comp;                 // SCC id of every vertex
+    std::vector<int> compSize;             // Number of vertices in every SCC
+    std::vector<std::vector<int>> dag;     // Deduplicated edges between SCCs
+    int dagEdges = 0;                      // Total number of DAG edges
+    std::vector<int> level;                // Longest path from a source SCC (topological level)
+    std::vector<int> pre, post;            // DFS spanning tree interval of every SCC
+    std::vector<int> low;                  // Smallest post number reachable from every SCC
+    std::vector<int> mark;                 // Visit stamps used by the fallback search
+    int stamp = 0;                         // Current visit stamp
+};
+
+// Function to build the condensation DAG and its index from the SCCs of the graph
+void buildCondensation(Condensation& cond, const std::vector<std::list<int>>& adj,
+                       const std::vector<std::vector<int>>& sccs);
+
+// Function to check whether SCC 'from' can reach SCC 'to' using the index
+bool condensationReaches(Condensation& cond, int from, int to);
+
+// Function to format the condensation DAG as a response for the client
+std::string formatCondensation(const Condensation& cond);
+
+#endif // CONDENSATION_HPP
@@ -0,0 +1,231 @@
+#include "graph_registry.hpp"
+#include "async_logger.hpp"
+#include "scc_trace.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+const string DEFAULT_GRAPH = "default";
+
+// Bytes of one std::list<int> node: two links and the value, rounded up to the malloc granularity
+static const size_t LIST_NODE_BYTES = (2 * sizeof(void*) + sizeof(int) + 15) / 16 * 16;
+
+static map<string, shared_ptr<GraphState>> registry; // All graphs by name
+static mutex registryMutex; // Protects the map only, never held together with a graph mutex
+static atomic<uint64_t> useClock(0); // Source of the LRU stamps
+static size_t memoryBudget = 0; // Bytes all resident graphs may use together, 0 means unlimited
+static atomic<size_t> jobBytes(0); // Bytes of the graph copies that asynchronous jobs are running on
+static string spillDirectory = "."; // Where evicted graphs are written
+
+// Function to set the memory budget of all resident graphs and where evicted graphs are written
+void configureRegistry(size_t budgetBytes, const string& spillDir) {
+    memoryBudget = budgetBytes;
+    spillDirectory = spillDir;
+}
+
+// Function to check that a graph name is safe to use as a file name
+bool validGraphName(const string& name) {
+    if (name.empty() || name.size() > 64) {
+        return false;
+    }
+    for (char c : name) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Function to look up a graph by name, creating an empty one if it does not exist yet
+shared_ptr<GraphState> getGraph(const string& name) {
+    lock_guard<mutex> lock(registryMutex);
+    shared_ptr<GraphState>& entry = registry[name];
+    if (!entry) {
+        entry = make_shared<GraphState>();
+        entry->name = name;
+        entry->lastUse = ++useClock;
+    }
+    return entry;
+}
+
+// Function to copy the registry so it can be walked without holding its mutex
+static vector<shared_ptr<GraphState>> registeredGraphs() {
+    lock_guard<mutex> lock(registryMutex);
+    vector<shared_ptr<GraphState>> graphs;
+    for (const auto& entry : registry) {
+        graphs.push_back(entry.second);
+    }
+    return graphs;
+}
+
+// Function to get the path of the spill file of a graph
+static string spillPath(const GraphState& g) {
+    return spillDirectory + "/" + g.name + ".graph";
+}
+
+// Function to write a graph to its spill file in the graph.txt format and free its memory
+static bool spillGraph(GraphState& g) {
+    ofstream out(spillPath(g));
+    out << g.n << " " << g.m << "\n";
+    for (int v = 0; v < g.n; ++v) {
+        for (int neighbor : g.adj[v]) {
+            out << (v + 1) << " " << (neighbor + 1) << "\n";
+        }
+    }
+    out.close();
+    if (!out) {
+        logError("Could not write " + spillPath(g) + ", graph " + g.name + " stays in memory");
+        return false;
+    }
+
+    vector<list<int>>().swap(g.adj); // Release the memory, not just the contents
+    vector<int>().swap(g.transposeOffsets);
+    vector<int>().swap(g.transposeTargets);
+    g.condensation = Condensation();
+    g.onDisk = true;
+    g.memoryBytes = 0;
+    logInfo("Graph " + g.name + " evicted to " + spillPath(g));
+    return true;
+}
+
+// Function to bring an evicted graph back into memory and mark it as used (graph mutex held)
+bool loadGraph(GraphState& g) {
+    SCC_TRACE_SPAN("load");
+    g.lastUse = ++useClock;
+    if (!g.onDisk) {
+        return true;
+    }
+
+    ifstream in(spillPath(g));
+    int vertices = -1, edges = -1;
+    in >> vertices >> edges;
+    bool ok = in && vertices >= 0 && edges >= 0;
+    vector<list<int>> adj(ok ? vertices : 0);
+    int u, v;
+    for (int i = 0; ok && i < edges; ++i) { // Ids are checked, a corrupt file must not index past adj
+        ok = in >> u >> v && u >= 1 && u <= vertices && v >= 1 && v <= vertices;
+        if (ok) {
+            adj[u - 1].push_back(v - 1); // The file keeps the adjacency order, so results do not change
+        }
+    }
+    if (!ok) { // Keep the spill file, it is the only copy; the next use tries again
+        logError("Could not read " + spillPath(g) + ", graph " + g.name + " stays on disk");
+        return false;
+    }
+
+    g.adj.swap(adj);
+    g.n = vertices;
+    g.m = edges;
+    remove(spillPath(g).c_str()); // The memory copy is the only copy again
+    g.onDisk = false;
+    updateMemory(g);
+    logInfo("Graph " + g.name + " loaded from disk");
+    return true;
+}
+
+// Function to recompute the memory estimate of a graph after it changed (graph mutex held)
+void updateMemory(GraphState& g) {
+    if (g.onDisk) {
+        g.memoryBytes = 0;
+        return;
+    }
+    const Condensation& c = g.condensation;
+    // g.m is kept up to date by every mutation, so the list nodes need not be counted row by row
+    size_t bytes = g.adj.capacity() * sizeof(list<int>) + static_cast<size_t>(g.m) * LIST_NODE_BYTES +
+                   (g.transposeOffsets.capacity() + g.transposeTargets.capacity()) * sizeof(int) +
+                   (c.comp.capacity() + c.compSize.capacity() + c.level.capacity() + c.pre.capacity() +
+                    c.post.capacity() + c.low.capacity() + c.mark.capacity() + c.dagEdges) * sizeof(int) +
+                   c.dag.capacity() * sizeof(vector<int>);
+    g.memoryBytes = bytes;
+}
+
+// Function to forget the spill file of a graph that is being replaced (graph mutex held)
+void discardSpill(GraphState& g) {
+    if (g.onDisk) {
+        remove(spillPath(g).c_str());
+        g.onDisk = false;
+    }
+}
+
+// Function to count the graph copy of a job against the budget until it is released
+void reserveJobMemory(size_t bytes) {
+    jobBytes += bytes;
+}
+
+// Function to stop counting the graph copy of a finished job
+void releaseJobMemory(size_t bytes) {
+    jobBytes -= bytes;
+}
+
+// Function to evict least recently used graphs to disk until the budget is met (no graph mutex held)
+void enforceMemoryBudget() {
+    if (memoryBudget == 0) {
+        return;
+    }
+    vector<shared_ptr<GraphState>> graphs = registeredGraphs();
+    size_t total = jobBytes; // Job copies cannot be evicted, so the resident graphs have to make room
+    for (const auto& g : graphs) {
+        total += g->memoryBytes;
+    }
+    if (total <= memoryBudget) {
+        return;
+    }
+
+    sort(graphs.begin(), graphs.end(), [](const shared_ptr<GraphState>& a, const shared_ptr<GraphState>& b) {
+        return a->lastUse < b->lastUse; // Least recently used first
+    });
+    // The most recently used graph always stays resident, so a single large graph cannot thrash
+    for (size_t i = 0; i + 1 < graphs.size() && total > memoryBudget; ++i) {
+        GraphState& g = *graphs[i];
+        unique_lock<mutex> lock(g.mutex, try_to_lock);
+        if (!lock.owns_lock() || g.onDisk || g.memoryBytes == 0) {
+            continue; // A busy graph is in use right now, it is not a good victim anyway
+        }
+        size_t bytes = g.memoryBytes;
+        if (spillGraph(g)) {
+            total -= bytes;
+        }
+    }
+}
+
+// Function to handle the "Graphs" command (no graph mutex held)
+string listGraphs() {
+    stringstream ss;
+    size_t total = 0;
+    for (const auto& graph : registeredGraphs()) {
+        lock_guard<mutex> lock(graph->mutex);
+        size_t bytes = graph->memoryBytes;
+        total += bytes;
+        ss << "Graph " << graph->name << ": " << graph->n << " vertices, " << graph->m << " edges, ";
+        if (graph->onDisk) {
+            ss << "on disk" << endl;
+        } else {
+            ss << (bytes + 1023) / 1024 << " KB in memory";
+            const TrimStats& trim = graph->trimStats;
+            if (trim.vertices > 0) { // Only once Kosaraju ran on it
+                ss << ", last trim " << trim.sources + trim.sinks << " of " << trim.vertices << " vertices ("
+                   << trim.sources << " sources, " << trim.sinks << " sinks)";
+            }
+            ss << endl;
+        }
+    }
+    size_t copies = jobBytes;
+    if (copies > 0) {
+        ss << "Job copies: " << (copies + 1023) / 1024 << " KB in memory" << endl;
+        total += copies;
+    }
+    ss << "Total: " << (total + 1023) / 1024 << " KB in memory, budget ";
+    if (memoryBudget == 0) {
+        ss << "unlimited" << endl;
+    } else {
+        ss << memoryBudget / 1024 << " KB" << endl;
+    }
+    return ss.str();
+}
@@ -0,0 +1,42 @@
+#ifndef GRAPH_REGISTRY_HPP
+#define GRAPH_REGISTRY_HPP
+
+#include "kosaraju_server.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Name of the graph every client starts with
+extern const std::string DEFAULT_GRAPH;
+
+// Function to set the memory budget of all resident graphs and where evicted graphs are written
+void configureRegistry(size_t budgetBytes, const std::string& spillDir);
+
+// Function to check that a graph name is safe to use as a file name
+bool validGraphName(const std::string& name);
+
+// Function to look up a graph by name, creating an empty one if it does not exist yet
+std::shared_ptr<GraphState> getGraph(const std::string& name);
+
+// Function to bring an evicted graph back into memory and mark it as used (graph mutex held)
+bool loadGraph(GraphState& g);
+
+// Function to recompute the memory estimate of a graph after it changed (graph mutex held)
+void updateMemory(GraphState& g);
+
+// Function to forget the spill file of a graph that is being replaced (graph mutex held)
+void discardSpill(GraphState& g);
+
+// Function to count the graph copy of a job against the budget until it is released
+void reserveJobMemory(size_t bytes);
+
+// Function to stop counting the graph copy of a finished job
+void releaseJobMemory(size_t bytes);
+
+// Function to evict least recently used graphs to disk until the budget is met (no graph mutex held)
+void enforceMemoryBudget();
+
+// Function to handle the "Graphs" command (no graph mutex held)
+std::string listGraphs();
+
+#endif // GRAPH_REGISTRY_HPP
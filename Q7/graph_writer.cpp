@@ -0,0 +1,115 @@
+#include "graph_writer.hpp"
+#include "kosaraju_server.hpp"
+#include "graph_registry.hpp"
+#include "mpsc_queue.hpp"
+#include "async_logger.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+// Upper bound on the mutations applied under one lock, so readers are not starved by a long queue
+static const size_t MAX_BATCH = 4096;
+
+MPSCQueue<Mutation> mutationQueue; // Mutations from all client threads
+
+static atomic<bool> writerSleeping(false); // Set while the writer waits for work
+static mutex writerMutex; // Only used to park and wake the writer
+static condition_variable writerCond;
+
+static mutex appliedMutex; // Only used to park clients waiting for their mutations
+static condition_variable appliedCond;
+
+// Function to apply one mutation (mutex of its graph held)
+static void applyMutation(Mutation& mutation) {
+    GraphState& g = *mutation.graph;
+    if (mutation.type == Mutation::NEWGRAPH) {
+        discardSpill(g); // The evicted contents are replaced anyway, do not read them back
+    }
+    if (!loadGraph(g)) {
+        logError("Mutation of graph " + g.name + " dropped, the graph could not be loaded");
+        return;
+    }
+    switch (mutation.type) {
+        case Mutation::NEWGRAPH:
+            applyNewGraph(g, mutation.vertices, mutation.edges);
+            break;
+        case Mutation::NEWEDGE:
+            handleNewEdge(g, mutation.u, mutation.v);
+            break;
+        case Mutation::REMOVEEDGE:
+            handleRemoveEdge(g, mutation.u, mutation.v);
+            break;
+        case Mutation::NEWEDGES:
+        case Mutation::REMOVEEDGES:
+            applyEdgeBatch(g, mutation.edges, mutation.type == Mutation::REMOVEEDGES);
+            break;
+    }
+}
+
+// Function run by the writer thread: drain the queue and apply it batch by batch
+static void graphWriterLoop() {
+    vector<Mutation> batch;
+    Mutation mutation;
+    while (true) {
+        while (batch.size() < MAX_BATCH && mutationQueue.pop(mutation)) {
+            batch.push_back(move(mutation));
+        }
+
+        if (batch.empty()) { // Park until a producer pushes something
+            unique_lock<mutex> lock(writerMutex);
+            writerSleeping.store(true);
+            writerCond.wait(lock, [] { return !mutationQueue.empty(); });
+            writerSleeping.store(false);
+            continue;
+        }
+
+        // One lock acquisition per run of mutations to the same graph
+        for (size_t begin = 0, end; begin < batch.size(); begin = end) {
+            GraphState& g = *batch[begin].graph;
+            lock_guard<mutex> lock(g.mutex);
+            for (end = begin; end < batch.size() && batch[end].graph.get() == &g; ++end) {
+                applyMutation(batch[end]);
+            }
+            updateMemory(g);
+            g.version++; // Publish the new version of this graph
+        }
+        enforceMemoryBudget(); // The batch may have grown the graphs past the budget
+
+        {
+            lock_guard<mutex> lock(appliedMutex);
+            for (const Mutation& m : batch) {
+                m.session->applied.store(m.sessionSeq);
+            }
+        }
+        appliedCond.notify_all(); // Wake up clients waiting to read their own writes
+        batch.clear();
+    }
+}
+
+// Function to start the single graph-writer thread
+void startGraphWriter() {
+    thread writer(graphWriterLoop);
+    writer.detach(); // The writer lives as long as the server
+}
+
+// Function to queue a mutation; never blocks on other clients
+void submitMutation(ClientSession& session, Mutation mutation) {
+    mutation.session = &session;
+    mutation.sessionSeq = ++session.submitted;
+    mutationQueue.push(move(mutation));
+    if (writerSleeping.load()) { // Rare path: the writer is parked and needs a wakeup
+        lock_guard<mutex> lock(writerMutex);
+        writerCond.notify_one();
+    }
+}
+
+// Function to wait until the writer has applied every mutation of this client
+void waitForMutations(ClientSession& session) {
+    if (session.applied.load() == session.submitted) {
+        return; // Fast path: nothing pending
+    }
+    unique_lock<mutex> lock(appliedMutex);
+    appliedCond.wait(lock, [&session] { return session.applied.load() == session.submitted; });
+}
@@ -0,0 +1,39 @@
+#ifndef GRAPH_WRITER_HPP
+#define GRAPH_WRITER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct GraphState;
+
+// Per-connection bookkeeping of the mutations a client has queued
+struct ClientSession {
+    uint64_t submitted = 0;             // Mutations queued so far (client thread only)
+    std::atomic<uint64_t> applied{0};   // Mutations the writer has applied (written by the writer)
+};
+
+// One change to the graph, applied by the writer thread
+struct Mutation {
+    enum Type { NEWGRAPH, NEWEDGE, REMOVEEDGE, NEWEDGES, REMOVEEDGES };
+    Type type = NEWEDGE;
+    int u = 0, v = 0;                           // Edge endpoints for NEWEDGE / REMOVEEDGE
+    int vertices = 0;                           // Vertex count for NEWGRAPH
+    std::vector<std::pair<int, int>> edges;     // Edges for NEWGRAPH, NEWEDGES and REMOVEEDGES
+    std::shared_ptr<GraphState> graph;          // Graph the mutation applies to
+    ClientSession* session = nullptr;           // Client that queued the mutation
+    uint64_t sessionSeq = 0;                    // Position in that client's sequence of mutations
+};
+
+// Function to start the single graph-writer thread
+void startGraphWriter();
+
+// Function to queue a mutation; never blocks on other clients
+void submitMutation(ClientSession& session, Mutation mutation);
+
+// Function to wait until the writer has applied every mutation of this client
+void waitForMutations(ClientSession& session);
+
+#endif // GRAPH_WRITER_HPP
@@ -1,4 +1,14 @@
 #include "kosaraju_server.hpp" // Include the header file for function declarations and global variables
+#include "condensation.hpp" // Include the condensation DAG and reachability index
+#include "graph_writer.hpp" // Include the single graph-writer thread and its mutation queue
+#include "graph_registry.hpp" // Include the named graphs and their memory budget
+#include "compute_jobs.hpp" // Include the compute pool for asynchronous Kosaraju jobs
+#include "metrics.hpp"      // Include the counters and latency histograms
+#include "async_logger.hpp" // Include the logger that keeps stdout off the request path
+#include "scc_trace.hpp"    // Include the phase spans of "Kosaraju profile"
+#include "line_reader.hpp"  // Include the buffered reader of client lines
+#include "../scc/scc.hpp"   // Include the shared SCC library
+#include "../scc/reach.hpp" // Include the reachability BFS of the SCC library
 #include <iostream>     // Include standard I/O library
 #include <sstream>      // Include string stream
 #include <string>       // Include string library
@@ -11,136 +21,327 @@
 #include <thread>       // Include threading utilities
 #include <algorithm>    // Include algorithms like transform
 #include <chrono>       // Include time utilities
+#include <cstdlib>      // Include strtoul for the command line
+#include <climits>      // Include INT_MAX
 
 using namespace std;
 
-// Global variables to store the graph and protect it with a mutex
-vector<list<int>> adj; // Adjacency list for the graph
-vector<list<int>> transposedAdj; // Transposed adjacency list for the graph
-int n, m; // Number of vertices and edges in the graph
-mutex graph_mutex; // Mutex to protect the graph data structure
-
-// Function to perform DFS and fill the stack
-void fillOrder(int v, vector<bool>& visited, stack<int>& Stack) {
-    visited[v] = true; // Mark the current node as visited
-    for (int neighbor : adj[v]) { // Iterate over all the adjacent vertices
-        if (!visited[neighbor]) { // If the adjacent vertex has not been visited
-            fillOrder(neighbor, visited, Stack); // Recursive call for the adjacent vertex
+// SCC library visitor that reports the passes to an optional progress record and to the active trace
+struct SCCVisitor : scc::NoVisitor {
+    SCCProgress* progress;
+    TracePhases phases; // "first pass" and "second pass" spans of "Kosaraju profile"
+
+    explicit SCCVisitor(SCCProgress* progress) : progress(progress) {}
+
+    bool cancelled() const {
+        return progress && progress->cancelled.load(memory_order_relaxed); // The passes stop at the next vertex
+    }
+
+    void phase(scc::Phase phase) {
+        if (phase == scc::FIRST_PASS || phase == scc::SECOND_PASS) {
+            if (progress) {
+                progress->phase = phase == scc::FIRST_PASS ? SCCProgress::FIRST_PASS : SCCProgress::SECOND_PASS;
+            }
+            phases.next(scc::phaseName(phase));
+        } else if (phase == scc::DONE) {
+            phases.next(nullptr);
         }
     }
-    Stack.push(v); // Push the vertex to the stack after all its adjacent vertices are processed
-}
 
-// Function to perform DFS on the transposed graph
-void DFSUtil(int v, vector<bool>& visited, vector<int>& component) {
-    visited[v] = true; // Mark the current node as visited
-    component.push_back(v); // Add this vertex to the current component
-    for (int neighbor : transposedAdj[v]) { // Iterate over all the adjacent vertices in the transposed graph
-        if (!visited[neighbor]) { // If the adjacent vertex has not been visited
-            DFSUtil(neighbor, visited, component); // Recursive call for the adjacent vertex
+    void component(const int* first, const int* last) {
+        if (progress) {
+            progress->finished.fetch_add(last - first, memory_order_relaxed);
         }
     }
+};
+
+// Function to get the number of threads of the compute pool, the transpose and the reachability BFS
+int computeThreads() {
+    static const int threads = max(1u, thread::hardware_concurrency()); // Asked once, it may read /sys
+    return threads;
 }
 
-// Function to get the transposed graph
-void getTranspose() {
-    transposedAdj = vector<list<int>>(n); // Create a transposed adjacency list with n vertices
-    for (int v = 0; v < n; ++v) { // Iterate over each vertex
-        for (int neighbor : adj[v]) { // Iterate over all the adjacent vertices
-            transposedAdj[neighbor].push_back(v); // Add an edge from neighbor to v in the transposed graph
-        }
+// Function to make sure the cached transposed graph matches the current graph. It is rebuilt after the
+// writer applied a batch (version) or after the graph was evicted (the rows were freed), not per query.
+void getTranspose(GraphState& g) {
+    if (g.transposeVersion == g.version && g.transposeOffsets.size() == static_cast<size_t>(g.n) + 1) {
+        return;
     }
+    SCC_TRACE_SPAN("transpose");
+    vector<pair<int, int>> scratch; // Edges partitioned by target, only needed while building
+    scc::transposeCSR(g.adj, g.transposeOffsets, g.transposeTargets, computeThreads(), scratch);
+    g.transposeVersion = g.version;
 }
 
-// Function to find and return all strongly connected components (SCCs)
-string findSCCs() {
-    stack<int> Stack; // Stack to store the order of vertices by finishing times
-    vector<bool> visited(n, false); // Visited array to keep track of visited vertices
-
-    // Perform DFS to fill the stack with vertices in order of finishing times
-    for (int i = 0; i < n; ++i) {
-        if (!visited[i]) {
-            fillOrder(i, visited, Stack);
+// Function to peel vertices with no incoming or no outgoing edges as trivial SCCs
+void trimTrivialSCCs(GraphState& g, vector<bool>& trimmed, vector<int>& sources, vector<int>& sinks) {
+    SCC_TRACE_SPAN("trim");
+    vector<int> inDegree(g.n), outDegree(g.n); // Degree counters of the residual graph
+    vector<int> queue; // Vertices whose residual in- or out-degree dropped to zero
+    for (int v = 0; v < g.n; ++v) {
+        inDegree[v] = g.transposeOffsets[v + 1] - g.transposeOffsets[v];
+        outDegree[v] = g.adj[v].size();
+        if (inDegree[v] == 0 || outDegree[v] == 0) {
+            queue.push_back(v);
         }
     }
 
-    getTranspose(); // Get the transposed graph
+    // Peeling a vertex lowers the degrees of its neighbors, which may expose new trivial SCCs
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int v = queue[head];
+        if (trimmed[v]) {
+            continue; // Already peeled (queued for both degrees)
+        }
+        trimmed[v] = true;
+        if (inDegree[v] == 0) {
+            sources.push_back(v); // Nothing left points to v: it precedes the rest of the graph
+        } else {
+            sinks.push_back(v); // v points to nothing left: it follows the rest of the graph
+        }
+        for (int neighbor : g.adj[v]) {
+            if (!trimmed[neighbor] && --inDegree[neighbor] == 0) {
+                queue.push_back(neighbor);
+            }
+        }
+        for (int i = g.transposeOffsets[v]; i < g.transposeOffsets[v + 1]; ++i) {
+            int neighbor = g.transposeTargets[i];
+            if (!trimmed[neighbor] && --outDegree[neighbor] == 0) {
+                queue.push_back(neighbor);
+            }
+        }
+    }
+
+    g.trimStats.vertices = g.n;
+    g.trimStats.sources = sources.size();
+    g.trimStats.sinks = sinks.size();
+}
+
+// Function to compute all strongly connected components (SCCs) in the order Kosaraju finds them
+vector<vector<int>> computeSCCs(GraphState& g, SCCProgress* progress) {
+    auto start = chrono::steady_clock::now(); // SCC compute time, whichever command asked for it
+    getTranspose(g); // Get (or reuse) the transposed graph, its rows also give the in-degrees for trimming
+
+    vector<bool> trimmed(g.n, false); // Vertices peeled off as trivial SCCs
+    vector<int> sources, sinks; // Trimmed vertices, in peeling order
+    trimTrivialSCCs(g, trimmed, sources, sinks);
+    logInfo("Graph " + g.name + ": trimmed " + to_string(sources.size() + sinks.size()) + " of " + to_string(g.n) +
+            " vertices (" + to_string(sources.size()) + " sources, " + to_string(sinks.size()) + " sinks)");
+    if (progress) {
+        progress->finished += sources.size() + sinks.size(); // Trimmed vertices are SCCs of their own already
+    }
+
+    // Kosaraju on the residual graph, reusing the transpose the trimming needed anyway
+    SCCVisitor visitor(progress);
+    scc::SCC<vector<list<int>>> solver;
+    const scc::Components& components = solver.runWithTranspose(
+        g.adj, scc::CSRView<>(g.n, g.transposeOffsets.data(), g.transposeTargets.data()), visitor, &trimmed);
+
+    vector<vector<int>> sccs; // Vector to store all SCCs
+    for (int v : sources) { // Trimmed sources come first in topological order
+        sccs.push_back(vector<int>(1, v));
+    }
+    for (int c = 0; c < components.size(); ++c) {
+        sccs.push_back(vector<int>(components.begin(c), components.end(c)));
+    }
+
+    for (auto it = sinks.rbegin(); it != sinks.rend(); ++it) { // Trimmed sinks come last, latest peeled first
+        sccs.push_back(vector<int>(1, *it));
+    }
 
-    fill(visited.begin(), visited.end(), false); // Mark all vertices as not visited for the second DFS
+    if (progress && progress->cancelled) {
+        sccs.clear(); // Partial results are not SCCs
+    } else {
+        recordSCCCompute(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+    }
+    return sccs; // Return the SCCs
+}
 
+// Function to format SCCs as a response for the client
+string formatSCCs(const vector<vector<int>>& sccs) {
+    SCC_TRACE_SPAN("serialize");
     stringstream ss; // String stream to store the SCCs result
-    int scc_count = 0; // Counter for SCCs
-
-    // Process all vertices in order defined by the stack
-    while (!Stack.empty()) {
-        int v = Stack.top();
-        Stack.pop();
-
-        if (!visited[v]) {
-            vector<int> component; // Vector to store the current SCC
-            DFSUtil(v, visited, component); // Perform DFS on the transposed graph
-            ss << "SCC " << ++scc_count << " is: ";
-            for (int vertex : component) {
-                ss << (vertex + 1) << " "; // Add vertices to the SCC result
-            }
-            ss << endl;
+
+    for (size_t i = 0; i < sccs.size(); ++i) {
+        ss << "SCC " << (i + 1) << " is: ";
+        for (int vertex : sccs[i]) {
+            ss << (vertex + 1) << " "; // Add vertices to the SCC result
         }
+        ss << endl;
     }
 
     return ss.str(); // Return the result string
 }
 
-// Function to handle the "Newgraph" command
-void handleNewGraph(int vertices, int edges, int client_fd) {
-    n = vertices; // Set the number of vertices
-    m = edges; // Set the number of edges
-    adj = vector<list<int>>(n); // Initialize the adjacency list with n vertices
-    char buf[256]; // Buffer to store received data
+// Function to find and return all strongly connected components (SCCs)
+string findSCCs(GraphState& g) {
+    return formatSCCs(computeSCCs(g)); // Compute the SCCs
+}
+
+// Function to make sure the cached condensation DAG matches the current graph
+void ensureCondensation(GraphState& g) {
+    if (!g.condensation.valid) {
+        buildCondensation(g.condensation, g.adj, computeSCCs(g)); // Rebuild only after the graph changed
+    }
+}
+
+// Function to handle the "Condense" command
+string handleCondense(GraphState& g) {
+    ensureCondensation(g);
+    return formatCondensation(g.condensation);
+}
+
+// Function to handle the "Reach" command
+string handleReach(GraphState& g, int u, int v) {
+    if (u < 1 || u > g.n || v < 1 || v > g.n) {
+        return "Invalid vertex.\n";
+    }
+    ensureCondensation(g);
+    bool reachable = condensationReaches(g.condensation, g.condensation.comp[u - 1], g.condensation.comp[v - 1]);
+    return to_string(u) + (reachable ? " reaches " : " does not reach ") + to_string(v) + ".\n";
+}
+
+// Function to handle the "Reach v" and "ReachedBy v" commands: the vertices v reaches (or that reach v)
+// with a direction-optimizing BFS over the adjacency lists and the transpose Kosaraju caches. With
+// "bitmap" the set follows as hex digits of four vertices each, vertex 1 in the lowest bit of the first.
+string handleReachSet(GraphState& g, int v, bool reachedBy, bool bitmap) {
+    if (v < 1 || v > g.n) {
+        return "Invalid vertex.\n";
+    }
+    getTranspose(g);
+    scc::CSRView<> transposed(g.n, g.transposeOffsets.data(), g.transposeTargets.data());
+    scc::ReachBFS bfs;
+    bfs.setThreads(computeThreads());
+    int count;
+    {
+        SCC_TRACE_SPAN("bfs");
+        count = reachedBy ? bfs.run(transposed, g.adj, v - 1) : bfs.run(g.adj, transposed, v - 1);
+    }
+
+    string response = to_string(v) + (reachedBy ? " is reached by " : " reaches ") + to_string(count) + " of " +
+                      to_string(g.n) + " vertices.\n";
+    if (bitmap) {
+        static const char digits[] = "0123456789abcdef";
+        const vector<uint64_t>& reached = bfs.reached();
+        string hex;
+        for (int first = 0; first < g.n; first += 4) {
+            hex += digits[(reached[first >> 6] >> (first & 63)) & 15]; // Bits past n are never set
+        }
+        response += "Bitmap: " + hex + "\n";
+    }
+    return response;
+}
+
+// Function to receive the edges of the "Newgraph", "Newedges" and "Removeedges" commands; returns false if
+// the client hung up
+bool receiveEdges(int vertices, int edges, LineReader& reader, int client_fd, vector<pair<int, int>>& received) {
+    string line;
     int u, v;
 
-    for (int i = 0; i < m; ++i) {
-        memset(buf, 0, sizeof(buf)); // Clear the buffer
-        int nbytes = recv(client_fd, buf, sizeof(buf) - 1, 0); // Receive data from the client
-        if (nbytes <= 0) {
-            if (nbytes == 0) {
-                cout << "Socket " << client_fd << " hung up" << endl;
+    for (int i = 0; i < edges; ++i) {
+        int status = reader.readLine(line); // Receive the next edge from the client
+        if (status <= 0) {
+            if (status == 0) {
+                logInfo("Socket " + to_string(client_fd) + " hung up");
             } else {
                 perror("recv");
             }
-            close(client_fd); // Close the client socket
-            return;
+            return false;
         }
-        buf[nbytes] = '\0'; // Null-terminate the buffer
-        stringstream ss(buf); // Create a string stream from the buffer
+        u = v = 0;
+        stringstream ss(line); // Create a string stream from the line
         ss >> u >> v; // Parse the edge endpoints
-        if (u < 1 || u > n || v < 1 || v > n) {
-            cerr << "Invalid edge: " << u << " " << v << endl;
+        if (u < 1 || u > vertices || v < 1 || v > vertices) {
+            logError("Invalid edge: " + to_string(u) + " " + to_string(v));
             --i; // Retry the current edge
             continue;
         }
-        adj[u - 1].push_back(v - 1); // Add the edge to the adjacency list
+        received.push_back(make_pair(u, v));
     }
-    cout << "Graph with " << n << " vertices and " << m << " edges created." << endl;
+    return true;
+}
+
+// Function to replace the graph for the "Newgraph" command (called by the writer with the graph mutex held)
+void applyNewGraph(GraphState& g, int vertices, const vector<pair<int, int>>& edges) {
+    g.n = vertices; // Set the number of vertices
+    g.m = edges.size(); // Set the number of edges
+    g.adj = vector<list<int>>(g.n); // Initialize the adjacency list with n vertices
+    g.condensation = Condensation(); // The cached condensation belongs to the old graph
+    g.trimStats = TrimStats(); // So are the trimming statistics
+    for (const auto& edge : edges) {
+        g.adj[edge.first - 1].push_back(edge.second - 1); // Add the edge to the adjacency list
+    }
+    logInfo("Graph " + g.name + " with " + to_string(g.n) + " vertices and " + to_string(g.m) + " edges created.");
 }
 
 // Function to handle the "Newedge" command
-void handleNewEdge(int u, int v) {
-    if (u < 1 || u > n || v < 1 || v > n) {
-        cerr << "Invalid edge: " << u << " " << v << endl;
+void handleNewEdge(GraphState& g, int u, int v) {
+    if (u < 1 || u > g.n || v < 1 || v > g.n) {
+        logError("Invalid edge: " + to_string(u) + " " + to_string(v));
         return;
     }
-    adj[u - 1].push_back(v - 1); // Add the edge to the adjacency list
-    cout << "Edge added: " << u << " -> " << v << endl;
+    g.adj[u - 1].push_back(v - 1); // Add the edge to the adjacency list
+    g.m++;
+    g.condensation.valid = false; // The new edge may merge SCCs
+    logInfo("Edge added to " + g.name + ": " + to_string(u) + " -> " + to_string(v));
 }
 
 // Function to handle the "Removeedge" command
-void handleRemoveEdge(int u, int v) {
-    if (u < 1 || u > n || v < 1 || v > n) {
-        cerr << "Invalid edge: " << u << " " << v << endl;
+void handleRemoveEdge(GraphState& g, int u, int v) {
+    if (u < 1 || u > g.n || v < 1 || v > g.n) {
+        logError("Invalid edge: " + to_string(u) + " " + to_string(v));
         return;
     }
-    adj[u - 1].remove(v - 1); // Remove the edge from the adjacency list
-    cout << "Edge removed: " << u << " -> " << v << endl;
+    size_t before = g.adj[u - 1].size();
+    g.adj[u - 1].remove(v - 1); // Remove the edge from the adjacency list
+    g.m -= before - g.adj[u - 1].size(); // Parallel edges are removed together
+    g.condensation.valid = false; // The removed edge may split an SCC
+    logInfo("Edge removed from " + g.name + ": " + to_string(u) + " -> " + to_string(v));
+}
+
+// Function to handle the "Newedges" and "Removeedges" commands (called by the writer with the graph mutex
+// held). The edges are sorted by source and every touched list is changed once: added edges are spliced
+// on in the order they were sent, removals filter the list in one pass against its sorted targets.
+void applyEdgeBatch(GraphState& g, vector<pair<int, int>>& edges, bool remove) {
+    size_t valid = 0;
+    for (const auto& edge : edges) { // The graph may have been replaced since the client sent them
+        if (edge.first >= 1 && edge.first <= g.n && edge.second >= 1 && edge.second <= g.n) {
+            edges[valid++] = make_pair(edge.first - 1, edge.second - 1);
+        }
+    }
+    size_t invalid = edges.size() - valid;
+    edges.resize(valid);
+    stable_sort(edges.begin(), edges.end(), [](const pair<int, int>& a, const pair<int, int>& b) {
+        return a.first < b.first; // Stable: the lists grow in the order the edges were sent
+    });
+
+    vector<int> targets; // Targets of one source
+    size_t changed = 0;
+    for (size_t begin = 0, end; begin < edges.size(); begin = end) {
+        int u = edges[begin].first;
+        for (end = begin; end < edges.size() && edges[end].first == u; ++end) {
+        }
+        if (!remove) {
+            list<int> added;
+            for (size_t i = begin; i < end; ++i) {
+                added.push_back(edges[i].second);
+            }
+            g.adj[u].splice(g.adj[u].end(), added);
+            changed += end - begin;
+        } else {
+            targets.clear();
+            for (size_t i = begin; i < end; ++i) {
+                targets.push_back(edges[i].second);
+            }
+            sort(targets.begin(), targets.end());
+            size_t before = g.adj[u].size();
+            g.adj[u].remove_if([&targets](int w) { return binary_search(targets.begin(), targets.end(), w); });
+            changed += before - g.adj[u].size(); // Parallel edges are removed together
+        }
+    }
+    g.m += remove ? -static_cast<int>(changed) : static_cast<int>(changed);
+    g.condensation.valid = false; // Once for the whole batch
+    logInfo(to_string(changed) + (remove ? " edges removed from " : " edges added to ") + g.name + " in one batch" +
+            (invalid ? " (" + to_string(invalid) + " invalid edges skipped)" : ""));
 }
 
 // Function to convert a string to lowercase
@@ -152,60 +353,177 @@ string toLowerCase(const string& str) {
 
 // Function to handle client commands
 void handleClient(int client_fd) {
-    char buf[1024]; // Buffer to store received data
+    LineReader reader(client_fd); // Commands and edges are read line by line, however they were sent
+    string command; // The command line
+    ClientSession session; // Mutations this client has queued for the writer
+    shared_ptr<GraphState> graph = getGraph(DEFAULT_GRAPH); // Graph the commands of this client go to
+    shared_ptr<ClientConnection> connection = make_shared<ClientConnection>(); // Shared with the client's jobs
+    connection->fd = client_fd;
     while (true) {
-        int nbytes = recv(client_fd, buf, sizeof(buf) - 1, 0); // Receive data from the client
-        if (nbytes <= 0) {
-            if (nbytes == 0) {
-                cout << "Socket " << client_fd << " hung up" << endl;
+        int status = reader.readLine(command); // Receive the next command from the client
+        if (status <= 0) {
+            if (status == 0) {
+                logInfo("Socket " + to_string(client_fd) + " hung up");
             } else {
                 perror("recv");
             }
-            close(client_fd); // Close the client socket
-            return;
+            break;
         }
-        buf[nbytes] = '\0'; // Null-terminate the buffer
-        string command(buf); // Convert the buffer to a string
+        auto start = chrono::steady_clock::now(); // The command's latency counts from here to its response
         stringstream ss(command); // Create a string stream from the command
         string cmd; // String to store the parsed command
         ss >> cmd; // Parse the command
         cmd = toLowerCase(cmd); // Convert command to lowercase
+        CommandType type = commandType(cmd); // Histogram the latency goes to
+        string option; // Optional mode of "Kosaraju"
+        if (cmd == "kosaraju") {
+            ss >> option;
+        }
         string response; // String to store the response
-        {
-            lock_guard<mutex> lock(graph_mutex); // Lock the mutex for modifying the graph
-            if (cmd == "newgraph") {
-                int vertices, edges;
-                ss >> vertices >> edges; // Parse the number of vertices and edges
-                response = "Send the edges.\n";
-                send(client_fd, response.c_str(), response.length(), 0); // Send the response to the client
-                handleNewGraph(vertices, edges, client_fd); // Handle the Newgraph command
-                response = "New graph created.\n";
-                send(client_fd, response.c_str(), response.length(), 0); // Send the response to the client
-            } else if (cmd == "kosaraju") {
-                response = findSCCs(); // Find the SCCs
-                send(client_fd, response.c_str(), response.length(), 0); // Send the response to the client
-            } else if (cmd == "newedge") {
-                int u, v;
-                ss >> u >> v; // Parse the edge endpoints
-                handleNewEdge(u, v); // Handle the Newedge command
-                response = "Edge added.\n";
-                send(client_fd, response.c_str(), response.length(), 0); // Send the response to the client
-            } else if (cmd == "removeedge") {
-                int u, v;
-                ss >> u >> v; // Parse the edge endpoints
-                handleRemoveEdge(u, v); // Handle the Removeedge command
-                response = "Edge removed.\n";
-                send(client_fd, response.c_str(), response.length(), 0); // Send the response to the client
+
+        // Mutations go to the writer thread and never wait for other clients
+        if (cmd == "use") {
+            string name;
+            ss >> name; // Parse the graph name
+            if (validGraphName(name)) {
+                graph = getGraph(name); // Created empty on first use
+                response = "Using graph " + name + ".\n";
             } else {
-                response = "Invalid command.\n";
-                send(client_fd, response.c_str(), response.length(), 0); // Send the response to the client
+                response = "Invalid graph name.\n";
+            }
+            sendResponse(*connection, response); // Send the response to the client
+        } else if (cmd == "graphs") {
+            response = listGraphs(); // Names, sizes and memory of all graphs
+            sendResponse(*connection, response); // Send the response to the client
+        } else if (cmd == "newgraph") {
+            Mutation mutation;
+            mutation.type = Mutation::NEWGRAPH;
+            int edges = 0;
+            string first;
+            ss >> first; // Either a graph name or the number of vertices
+            if (!first.empty() && !isdigit(static_cast<unsigned char>(first[0]))) {
+                if (!validGraphName(first)) {
+                    response = "Invalid graph name.\n";
+                    sendResponse(*connection, response); // Send the response to the client
+                    recordCommand(type, chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+                    continue;
+                }
+                graph = getGraph(first); // "Newgraph g1 n m" also switches to g1
+                ss >> mutation.vertices;
+            } else {
+                mutation.vertices = atoi(first.c_str());
+            }
+            ss >> edges; // Parse the number of edges
+            mutation.graph = graph;
+            response = "Send the edges.\n";
+            sendResponse(*connection, response); // Send the response to the client
+            if (!receiveEdges(mutation.vertices, edges, reader, client_fd, mutation.edges)) {
+                break;
             }
+            submitMutation(session, move(mutation)); // Queue the new graph
+            response = "New graph created.\n";
+            sendResponse(*connection, response); // Send the response to the client
+        } else if (cmd == "newedge" || cmd == "removeedge") {
+            Mutation mutation;
+            mutation.type = cmd == "newedge" ? Mutation::NEWEDGE : Mutation::REMOVEEDGE;
+            mutation.graph = graph;
+            ss >> mutation.u >> mutation.v; // Parse the edge endpoints
+            submitMutation(session, move(mutation)); // Queue the edge change
+            response = cmd == "newedge" ? "Edge added.\n" : "Edge removed.\n";
+            sendResponse(*connection, response); // Send the response to the client
+        } else if (cmd == "newedges" || cmd == "removeedges") {
+            Mutation mutation;
+            mutation.type = cmd == "newedges" ? Mutation::NEWEDGES : Mutation::REMOVEEDGES;
+            mutation.graph = graph;
+            int edges = 0;
+            ss >> edges; // Parse the number of edges
+            response = "Send the edges.\n";
+            sendResponse(*connection, response); // Send the response to the client
+            // The writer checks them against the graph it applies them to, so any positive ids are accepted here
+            if (!receiveEdges(INT_MAX, edges, reader, client_fd, mutation.edges)) {
+                break;
+            }
+            submitMutation(session, move(mutation)); // Queue the whole batch as one mutation
+            response = cmd == "newedges" ? "Edges added.\n" : "Edges removed.\n";
+            sendResponse(*connection, response); // Send the response to the client
+        } else if (cmd == "kosaraju" && toLowerCase(option) == "async") {
+            waitForMutations(session); // The job sees this client's own earlier mutations
+            lock_guard<mutex> lock(connection->sendMutex); // The result must not overtake the job id
+            int id = submitSCCJob(graph, connection); // Runs on the compute pool, the result is sent when ready
+            response = "Job " + to_string(id) + " started.\n";
+            send(client_fd, response.c_str(), response.length(), MSG_NOSIGNAL); // Send the response to the client
+            recordBytesOut(response.length());
+        } else if (cmd == "stats") {
+            response = formatStats(); // Counters and latency percentiles of the whole server
+            sendResponse(*connection, response); // Send the response to the client
+        } else if (cmd == "status" || cmd == "cancel") {
+            int id = 0;
+            ss >> id; // Parse the job id
+            response = cmd == "status" ? jobStatus(id, *connection) : cancelJob(id, *connection);
+            sendResponse(*connection, response); // Send the response to the client
+        } else if (cmd == "trace") {
+            response = formatChromeTrace(); // Recently profiled queries, for chrome://tracing
+            sendResponse(*connection, response); // Send the response to the client
+        } else if (cmd == "kosaraju" || cmd == "condense" || cmd == "reach" || cmd == "reachedby") {
+            waitForMutations(session); // Queries see this client's own earlier mutations
+            bool profile = cmd == "kosaraju" && toLowerCase(option) == "profile"; // Time the phases of this query
+            QueryTrace trace;
+            if (profile) {
+                beginTrace(trace, graph->name);
+            }
+            {
+                unique_lock<mutex> lock(graph->mutex, defer_lock); // Only this graph is locked, other tenants keep working
+                {
+                    SCC_TRACE_SPAN("lock");
+                    lock.lock(); // Waits while a writer or another query holds the graph
+                }
+                if (!loadGraph(*graph)) {
+                    response = "Graph " + graph->name + " could not be loaded.\n";
+                } else if (cmd == "kosaraju") {
+                    response = findSCCs(*graph); // Find the SCCs
+                } else if (cmd == "condense") {
+                    response = handleCondense(*graph); // Build (or reuse) the condensation DAG
+                } else {
+                    int u = 0;
+                    string second; // Target vertex of "Reach u v", or the optional "bitmap"
+                    ss >> u >> second;
+                    if (cmd == "reach" && !second.empty() && isdigit(static_cast<unsigned char>(second[0]))) {
+                        response = handleReach(*graph, u, atoi(second.c_str())); // Answer from the cached reachability index
+                    } else {
+                        response = handleReachSet(*graph, u, cmd == "reachedby", toLowerCase(second) == "bitmap");
+                    }
+                }
+                updateMemory(*graph); // A reload or a new condensation changes the footprint
+            }
+            enforceMemoryBudget(); // Evict other graphs if this one grew past the budget
+            {
+                SCC_TRACE_SPAN("send");
+                sendResponse(*connection, response); // Send the response to the client
+            }
+            if (profile) {
+                endTrace(trace);
+                response = formatTrace(trace); // The breakdown follows the SCCs
+                sendResponse(*connection, response); // Send the response to the client
+            }
+        } else {
+            response = "Invalid command.\n";
+            sendResponse(*connection, response); // Send the response to the client
         }
+        recordCommand(type, chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+    }
+
+    waitForMutations(session); // The writer still points at this session until its mutations are applied
+    dropClientJobs(*connection); // Nobody is left to receive the results
+    {
+        lock_guard<mutex> lock(connection->sendMutex); // Jobs that finish from now on do not send to a reused fd
+        connection->open = false;
+        close(client_fd); // Close the client socket
     }
+    connectionClosed();
 }
 
 // Main function
-int main() {
+int main(int argc, char* argv[]) {
     int listener; // Listening socket descriptor
     struct sockaddr_in myaddr; // Server address
     int yes = 1; // Flag for setsockopt
@@ -241,6 +559,16 @@ int main() {
         exit(1);
     }
 
+    startLogger(); // Before any thread logs
+    size_t budgetMB = argc > 1 ? strtoul(argv[1], nullptr, 10) : 0; // Memory budget of all graphs, 0 means unlimited
+    configureRegistry(budgetMB * 1024 * 1024, argc > 2 ? argv[2] : "."); // Evicted graphs go to the spill directory
+    getGraph(DEFAULT_GRAPH); // Every client starts on the default graph
+
+    startGraphWriter(); // Start the thread that applies all graph mutations
+    startComputePool(computeThreads()); // Threads for asynchronous Kosaraju jobs
+    if (argc > 3 && startMetricsHttp(atoi(argv[3]))) { // Optional Prometheus endpoint on 127.0.0.1
+        cout << "Metrics on http://127.0.0.1:" << argv[3] << "/metrics" << endl;
+    }
     cout << "Server running, press Ctrl+C to exit..." << endl;
 
     // Main loop to accept and handle client connections
@@ -251,7 +579,8 @@ int main() {
         if (newfd == -1) {
             perror("accept");
         } else {
-            cout << "New connection from " << inet_ntoa(remoteaddr.sin_addr) << " on socket " << newfd << endl;
+            logInfo("New connection from " + string(inet_ntoa(remoteaddr.sin_addr)) + " on socket " + to_string(newfd));
+            connectionOpened();
             thread client_thread(handleClient, newfd); // Create a new thread to handle the client
             client_thread.detach(); // Detach the thread to handle the client independently
         }
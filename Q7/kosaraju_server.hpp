@@ -3,36 +3,93 @@
 
 #include <vector>
 #include <list>
-#include <stack>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <atomic>
+#include <cstdint>
+#include "condensation.hpp"
 
-// Global variables for the graph and mutex for thread safety
-extern std::vector<std::list<int>> adj;
-extern std::vector<std::list<int>> transposedAdj;
-extern int n, m;
-extern std::mutex graph_mutex;
+class LineReader;
 
-// Function to perform DFS and fill the stack
-void fillOrder(int v, std::vector<bool>& visited, std::stack<int>& Stack);
+// Statistics of the trimming stage that runs before Kosaraju
+struct TrimStats {
+    int vertices = 0; // Vertices in the graph
+    int sources = 0;  // Vertices trimmed because nothing left pointed to them
+    int sinks = 0;    // Vertices trimmed because they pointed to nothing left
+};
 
-// Function to perform DFS on the transposed graph
-void DFSUtil(int v, std::vector<bool>& visited, std::vector<int>& component);
+// One named graph of the server; everything but the atomics is protected by its mutex
+struct GraphState {
+    std::string name;                          // Name clients use in "Use" and "Newgraph"
+    std::vector<std::list<int>> adj;           // Adjacency list for the graph
+    std::vector<int> transposeOffsets;         // Transposed graph as CSR rows, kept for Kosaraju and "Reach v"
+    std::vector<int> transposeTargets;         // Sources of the edges into each vertex, row after row
+    uint64_t transposeVersion = 0;             // Version the transpose was built for
+    int n = 0, m = 0;                          // Number of vertices and edges in the graph
+    std::mutex mutex;                          // Protects this graph only, other graphs stay available
+    Condensation condensation;                 // Cached condensation DAG, rebuilt lazily after the graph changes
+    TrimStats trimStats;                       // Statistics of the last trimming stage
+    bool onDisk = false;                       // Evicted: the graph lives in its spill file until the next use
+    std::atomic<uint64_t> version{0};          // Bumped once per applied batch of mutations
+    std::atomic<size_t> memoryBytes{0};        // Estimated memory held while resident
+    std::atomic<uint64_t> lastUse{0};          // LRU stamp of the last access
+};
 
-// Function to get the transposed graph
-void getTranspose();
+// Progress of a Kosaraju run that another thread can watch and cancel
+struct SCCProgress {
+    enum Phase { TRIMMING, FIRST_PASS, SECOND_PASS };
+    std::atomic<int> phase{TRIMMING};     // Stage the run is in
+    std::atomic<int> finished{0};         // Vertices already assigned to an SCC
+    std::atomic<bool> cancelled{false};   // Set from outside, the passes stop at the next vertex
+};
+
+// Function to get the number of threads of the compute pool, the transpose and the reachability BFS
+int computeThreads();
+
+// Function to make sure the cached transposed graph matches the current graph
+void getTranspose(GraphState& g);
+
+// Function to peel vertices with no incoming or no outgoing edges as trivial SCCs
+void trimTrivialSCCs(GraphState& g, std::vector<bool>& trimmed, std::vector<int>& sources, std::vector<int>& sinks);
+
+// Function to compute all strongly connected components (SCCs) in the order Kosaraju finds them.
+// With a progress record the run reports how far it got, and returns no SCCs once it is cancelled.
+std::vector<std::vector<int>> computeSCCs(GraphState& g, SCCProgress* progress = nullptr);
+
+// Function to format SCCs as a response for the client
+std::string formatSCCs(const std::vector<std::vector<int>>& sccs);
 
 // Function to find and return all strongly connected components (SCCs)
-std::string findSCCs();
+std::string findSCCs(GraphState& g);
+
+// Function to make sure the cached condensation DAG matches the current graph
+void ensureCondensation(GraphState& g);
+
+// Function to handle the "Condense" command
+std::string handleCondense(GraphState& g);
+
+// Function to handle the "Reach" command
+std::string handleReach(GraphState& g, int u, int v);
+
+// Function to handle the "Reach v" and "ReachedBy v" commands, optionally with the set as a bitmap
+std::string handleReachSet(GraphState& g, int v, bool reachedBy, bool bitmap);
+
+// Function to receive the edges of the "Newgraph", "Newedges" and "Removeedges" commands; returns false if
+// the client hung up
+bool receiveEdges(int vertices, int edges, LineReader& reader, int client_fd, std::vector<std::pair<int, int>>& received);
+
+// Function to replace the graph for the "Newgraph" command (called by the writer with the graph mutex held)
+void applyNewGraph(GraphState& g, int vertices, const std::vector<std::pair<int, int>>& edges);
 
-// Function to handle the "Newgraph" command
-void handleNewGraph(int vertices, int edges, int client_fd);
+// Function to handle the "Newedge" command (called by the writer with the graph mutex held)
+void handleNewEdge(GraphState& g, int u, int v);
 
-// Function to handle the "Newedge" command
-void handleNewEdge(int u, int v);
+// Function to handle the "Removeedge" command (called by the writer with the graph mutex held)
+void handleRemoveEdge(GraphState& g, int u, int v);
 
-// Function to handle the "Removeedge" command
-void handleRemoveEdge(int u, int v);
+// Function to handle the "Newedges" and "Removeedges" commands (called by the writer with the graph mutex held)
+void applyEdgeBatch(GraphState& g, std::vector<std::pair<int, int>>& edges, bool remove);
 
 // Function to convert a string to lowercase
 std::string toLowerCase(const std::string& str);
@@ -0,0 +1,43 @@
+#include "line_reader.hpp"
+#include "metrics.hpp"
+#include <sys/socket.h>
+
+using namespace std;
+
+static const size_t RECV_BYTES = 65536;       // Bytes asked for per recv()
+static const size_t MAX_LINE_BYTES = 1 << 20; // Longer lines are cut, so a client cannot grow the buffer forever
+
+// Function to get the next line without its line ending
+int LineReader::readLine(string& line) {
+    size_t scanned = start; // Nothing before this is a newline
+    while (true) {
+        size_t end = buffer.find('\n', scanned);
+        if (end != string::npos || buffer.size() - start >= MAX_LINE_BYTES) {
+            size_t length = (end != string::npos ? end : buffer.size()) - start;
+            line.assign(buffer, start, length);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back(); // telnet ends its lines with \r\n
+            }
+            start = end != string::npos ? end + 1 : buffer.size();
+            if (start == buffer.size()) {
+                buffer.clear(); // Everything was read, the next recv() starts at the beginning again
+                start = 0;
+            }
+            return 1;
+        }
+        scanned = buffer.size();
+        if (start > 0) { // Move the partial line to the front before the buffer grows
+            buffer.erase(0, start);
+            scanned -= start;
+            start = 0;
+        }
+        size_t used = buffer.size();
+        buffer.resize(used + RECV_BYTES);
+        int nbytes = recv(fd, &buffer[used], RECV_BYTES, 0); // Receive data from the client
+        buffer.resize(used + (nbytes > 0 ? nbytes : 0));
+        if (nbytes <= 0) {
+            return nbytes;
+        }
+        recordBytesIn(nbytes);
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef LINE_READER_HPP
+#define LINE_READER_HPP
+
+#include <cstddef>
+#include <string>
+
+// Buffered reader of the lines a client sends. One recv() may carry many lines (a bulk edge upload)
+// and one line may arrive in pieces, so commands and edges are split at the newlines, not per recv().
+class LineReader {
+public:
+    explicit LineReader(int fd) : fd(fd) {}
+
+    // Function to get the next line without its line ending; returns 1, or what recv() returned when
+    // the client hung up (0) or the read failed (-1)
+    int readLine(std::string& line);
+
+private:
+    int fd;
+    std::string buffer;  // Received data, the unread part starts at start
+    size_t start = 0;
+};
+
+#endif // LINE_READER_HPP
@@ -0,0 +1,362 @@
+#include "metrics.hpp"
+#include "async_logger.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+using namespace std;
+
+// Sub-buckets per power of two: a recorded latency is off by less than 1 / SUB_BUCKETS of its value
+static const int SUB_BITS = 4;
+static const int SUB_BUCKETS = 1 << SUB_BITS;
+static const int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS; // Enough for any uint64_t
+
+static const char* COMMAND_NAMES[COMMAND_TYPES] = {"Newgraph", "Newedge", "Removeedge", "Newedges", "Removeedges",
+                                                   "Kosaraju", "Other"};
+
+// Upper bounds of the Prometheus histogram buckets, in microseconds
+static const uint64_t PROMETHEUS_BOUNDS[] = {10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000, 500000,
+                                             1000000, 5000000, 10000000};
+
+// Function to find the bucket of a value: exact below SUB_BUCKETS, then SUB_BUCKETS buckets per power of two
+static int bucketOf(uint64_t value) {
+    if (value < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return value;
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    int sub = (value >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+// Function to get the smallest value of a bucket
+static uint64_t bucketLow(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    int exponent = bucket / SUB_BUCKETS + SUB_BITS - 1;
+    return static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << (exponent - SUB_BITS);
+}
+
+// Function to get the largest value of a bucket
+static uint64_t bucketHigh(int bucket) {
+    return bucket + 1 < BUCKETS ? bucketLow(bucket + 1) - 1 : UINT64_MAX;
+}
+
+// Function to add to a counter that only its own thread writes, so no locked read-modify-write is needed
+static void bump(atomic<uint64_t>& counter, uint64_t delta) {
+    counter.store(counter.load(memory_order_relaxed) + delta, memory_order_relaxed);
+}
+
+// Merged contents of histograms, for reporting
+struct HistogramSnapshot {
+    vector<uint64_t> buckets = vector<uint64_t>(BUCKETS);
+    uint64_t count = 0, sum = 0, max = 0;
+
+    // Function to get the value below which a fraction q of the recorded values fall
+    uint64_t percentile(double q) const {
+        if (count == 0) {
+            return 0;
+        }
+        uint64_t rank = std::max(static_cast<uint64_t>(ceil(q * count)), static_cast<uint64_t>(1));
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += buckets[b];
+            if (seen >= rank) {
+                return min(bucketLow(b) + (bucketHigh(b) - bucketLow(b)) / 2, this->max); // Middle of the bucket
+            }
+        }
+        return this->max;
+    }
+
+    // Function to get how many values are at most bound, to the resolution of the buckets
+    uint64_t countUpTo(uint64_t bound) const {
+        uint64_t total = 0;
+        for (int b = 0; b < BUCKETS && bucketHigh(b) <= bound; ++b) {
+            total += buckets[b];
+        }
+        return total;
+    }
+
+    void add(const HistogramSnapshot& other) {
+        for (int b = 0; b < BUCKETS; ++b) {
+            buckets[b] += other.buckets[b];
+        }
+        count += other.count;
+        sum += other.sum;
+        max = std::max(max, other.max);
+    }
+};
+
+// Log-linear latency histogram in the style of HdrHistogram; written by one thread, read by any
+struct Histogram {
+    atomic<uint64_t> buckets[BUCKETS];
+    atomic<uint64_t> count{0}, sum{0}, max{0};
+
+    Histogram() {
+        for (int b = 0; b < BUCKETS; ++b) {
+            buckets[b].store(0, memory_order_relaxed);
+        }
+    }
+
+    void record(uint64_t value) {
+        bump(buckets[bucketOf(value)], 1);
+        bump(count, 1);
+        bump(sum, value);
+        if (value > max.load(memory_order_relaxed)) {
+            max.store(value, memory_order_relaxed);
+        }
+    }
+
+    void addTo(HistogramSnapshot& snapshot) const {
+        for (int b = 0; b < BUCKETS; ++b) {
+            snapshot.buckets[b] += buckets[b].load(memory_order_relaxed);
+        }
+        snapshot.count += count.load(memory_order_relaxed);
+        snapshot.sum += sum.load(memory_order_relaxed);
+        snapshot.max = std::max(snapshot.max, max.load(memory_order_relaxed));
+    }
+};
+
+// Metrics of one thread; only that thread writes them
+struct ThreadMetrics {
+    Histogram commands[COMMAND_TYPES]; // Latency of every command type
+    Histogram sccCompute;              // Duration of the SCC computations
+    atomic<uint64_t> bytesIn{0}, bytesOut{0};
+};
+
+// Sum of the metrics of many threads
+struct MetricsSnapshot {
+    HistogramSnapshot commands[COMMAND_TYPES];
+    HistogramSnapshot sccCompute;
+    uint64_t bytesIn = 0, bytesOut = 0;
+
+    void add(const ThreadMetrics& metrics) {
+        for (int t = 0; t < COMMAND_TYPES; ++t) {
+            metrics.commands[t].addTo(commands[t]);
+        }
+        metrics.sccCompute.addTo(sccCompute);
+        bytesIn += metrics.bytesIn.load(memory_order_relaxed);
+        bytesOut += metrics.bytesOut.load(memory_order_relaxed);
+    }
+};
+
+static mutex registryMutex; // Protects the two below; taken once per thread and per report, never per command
+static vector<ThreadMetrics*> liveThreads; // Metrics of the running threads
+static MetricsSnapshot retired; // Metrics of the threads that already exited
+
+static atomic<int64_t> openConnections(0);
+static atomic<uint64_t> totalConnections(0);
+
+// Registers the metrics of a thread on its first use and folds them into retired when it exits
+struct ThreadMetricsOwner {
+    ThreadMetrics* metrics = new ThreadMetrics();
+
+    ThreadMetricsOwner() {
+        lock_guard<mutex> lock(registryMutex);
+        liveThreads.push_back(metrics);
+    }
+
+    ~ThreadMetricsOwner() {
+        lock_guard<mutex> lock(registryMutex);
+        retired.add(*metrics);
+        for (size_t i = 0; i < liveThreads.size(); ++i) {
+            if (liveThreads[i] == metrics) {
+                liveThreads[i] = liveThreads.back();
+                liveThreads.pop_back();
+                break;
+            }
+        }
+        delete metrics;
+    }
+};
+
+// Function to get the metrics of the calling thread
+static ThreadMetrics& localMetrics() {
+    static thread_local ThreadMetricsOwner owner;
+    return *owner.metrics;
+}
+
+// Function to add up the metrics of all threads
+static MetricsSnapshot collect() {
+    lock_guard<mutex> lock(registryMutex);
+    MetricsSnapshot snapshot = retired;
+    for (ThreadMetrics* metrics : liveThreads) {
+        snapshot.add(*metrics);
+    }
+    return snapshot;
+}
+
+// Function to map a lowercase command name to its type
+CommandType commandType(const string& cmd) {
+    if (cmd == "newgraph") {
+        return CMD_NEWGRAPH;
+    } else if (cmd == "newedge") {
+        return CMD_NEWEDGE;
+    } else if (cmd == "removeedge") {
+        return CMD_REMOVEEDGE;
+    } else if (cmd == "newedges") {
+        return CMD_NEWEDGES;
+    } else if (cmd == "removeedges") {
+        return CMD_REMOVEEDGES;
+    } else if (cmd == "kosaraju") {
+        return CMD_KOSARAJU;
+    }
+    return CMD_OTHER;
+}
+
+// Function to count a command and record how long it took, from its arrival to its response
+void recordCommand(CommandType type, uint64_t micros) {
+    localMetrics().commands[type].record(micros);
+}
+
+// Function to record how long one SCC computation took
+void recordSCCCompute(uint64_t micros) {
+    localMetrics().sccCompute.record(micros);
+}
+
+// Function to count bytes received from a client
+void recordBytesIn(size_t bytes) {
+    bump(localMetrics().bytesIn, bytes);
+}
+
+// Function to count bytes sent to a client
+void recordBytesOut(size_t bytes) {
+    bump(localMetrics().bytesOut, bytes);
+}
+
+// Function to count a connection that was accepted
+void connectionOpened() {
+    openConnections.fetch_add(1, memory_order_relaxed);
+    totalConnections.fetch_add(1, memory_order_relaxed);
+}
+
+// Function to count a connection that was closed
+void connectionClosed() {
+    openConnections.fetch_sub(1, memory_order_relaxed);
+}
+
+// Function to format one histogram as a line of the "Stats" response
+static void formatHistogram(stringstream& ss, const string& name, const char* what, const HistogramSnapshot& h) {
+    ss << name << ": " << h.count << " " << what;
+    if (h.count > 0) {
+        ss << ", mean " << h.sum / h.count << " us, p50 " << h.percentile(0.5) << " us, p90 " << h.percentile(0.9)
+           << " us, p99 " << h.percentile(0.99) << " us, p99.9 " << h.percentile(0.999) << " us, max " << h.max
+           << " us";
+    }
+    ss << endl;
+}
+
+// Function to handle the "Stats" command
+string formatStats() {
+    MetricsSnapshot snapshot = collect();
+    stringstream ss;
+    ss << "Connections: " << openConnections.load() << " open, " << totalConnections.load() << " total" << endl;
+    ss << "Bytes: " << snapshot.bytesIn << " received, " << snapshot.bytesOut << " sent" << endl;
+    for (int t = 0; t < COMMAND_TYPES; ++t) {
+        formatHistogram(ss, COMMAND_NAMES[t], "commands", snapshot.commands[t]);
+    }
+    formatHistogram(ss, "SCC compute", "runs", snapshot.sccCompute);
+    ss << "Log lines dropped: " << droppedLogLines() << endl;
+    return ss.str();
+}
+
+// Function to format one histogram in the Prometheus text format, with the times in seconds
+static void formatPrometheusHistogram(stringstream& ss, const string& name, const string& labels,
+                                      const HistogramSnapshot& h) {
+    string separator = labels.empty() ? "" : ",";
+    for (uint64_t bound : PROMETHEUS_BOUNDS) {
+        ss << name << "_bucket{" << labels << separator << "le=\"" << bound / 1e6 << "\"} " << h.countUpTo(bound) << "\n";
+    }
+    ss << name << "_bucket{" << labels << separator << "le=\"+Inf\"} " << h.count << "\n";
+    string braces = labels.empty() ? "" : "{" + labels + "}";
+    ss << name << "_sum" << braces << " " << h.sum / 1e6 << "\n";
+    ss << name << "_count" << braces << " " << h.count << "\n";
+}
+
+// Function to format all metrics in the Prometheus text format
+string formatPrometheus() {
+    MetricsSnapshot snapshot = collect();
+    stringstream ss;
+    ss << "# HELP kosaraju_connections_open Client connections currently open.\n"
+       << "# TYPE kosaraju_connections_open gauge\n"
+       << "kosaraju_connections_open " << openConnections.load() << "\n"
+       << "# HELP kosaraju_connections_total Client connections accepted.\n"
+       << "# TYPE kosaraju_connections_total counter\n"
+       << "kosaraju_connections_total " << totalConnections.load() << "\n"
+       << "# HELP kosaraju_received_bytes_total Bytes received from clients.\n"
+       << "# TYPE kosaraju_received_bytes_total counter\n"
+       << "kosaraju_received_bytes_total " << snapshot.bytesIn << "\n"
+       << "# HELP kosaraju_sent_bytes_total Bytes sent to clients.\n"
+       << "# TYPE kosaraju_sent_bytes_total counter\n"
+       << "kosaraju_sent_bytes_total " << snapshot.bytesOut << "\n";
+
+    ss << "# HELP kosaraju_command_duration_seconds Time from a command's arrival to its response.\n"
+       << "# TYPE kosaraju_command_duration_seconds histogram\n";
+    for (int t = 0; t < COMMAND_TYPES; ++t) {
+        string labels = string("command=\"") + COMMAND_NAMES[t] + "\"";
+        formatPrometheusHistogram(ss, "kosaraju_command_duration_seconds", labels, snapshot.commands[t]);
+    }
+    ss << "# HELP kosaraju_scc_compute_seconds Duration of the SCC computations.\n"
+       << "# TYPE kosaraju_scc_compute_seconds histogram\n";
+    formatPrometheusHistogram(ss, "kosaraju_scc_compute_seconds", "", snapshot.sccCompute);
+    ss << "# HELP kosaraju_log_lines_dropped_total Log lines lost to a full log ring.\n"
+       << "# TYPE kosaraju_log_lines_dropped_total counter\n"
+       << "kosaraju_log_lines_dropped_total " << droppedLogLines() << "\n";
+    return ss.str();
+}
+
+// Function run by the metrics thread: answer every HTTP request with the metrics
+static void serveMetrics(int listener) {
+    while (true) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd == -1) {
+            perror("accept");
+            continue;
+        }
+        struct timeval timeout = {1, 0}; // A client that never sends its request does not hold the thread
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        char buf[4096];
+        if (recv(fd, buf, sizeof(buf), 0) > 0) { // The path does not matter, every request gets the metrics
+            string body = formatPrometheus();
+            string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                              to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+            send(fd, response.c_str(), response.length(), MSG_NOSIGNAL);
+        }
+        close(fd);
+    }
+}
+
+// Function to serve the Prometheus metrics over HTTP on a local port, from a thread of its own
+bool startMetricsHttp(int port) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == -1) {
+        perror("socket");
+        return false;
+    }
+    int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(int));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Local only, the metrics are not for the clients
+    addr.sin_port = htons(port);
+    if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) == -1 || listen(listener, 10) == -1) {
+        perror("metrics port");
+        close(listener);
+        return false;
+    }
+    thread server(serveMetrics, listener);
+    server.detach(); // The metrics thread lives as long as the server
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Command types that get their own counter and latency histogram
+enum CommandType {
+    CMD_NEWGRAPH, CMD_NEWEDGE, CMD_REMOVEEDGE, CMD_NEWEDGES, CMD_REMOVEEDGES, CMD_KOSARAJU, CMD_OTHER, COMMAND_TYPES
+};
+
+// Function to map a lowercase command name to its type
+CommandType commandType(const std::string& cmd);
+
+// Function to count a command and record how long it took, from its arrival to its response
+void recordCommand(CommandType type, uint64_t micros);
+
+// Function to record how long one SCC computation took
+void recordSCCCompute(uint64_t micros);
+
+// Function to count bytes received from a client
+void recordBytesIn(size_t bytes);
+
+// Function to count bytes sent to a client
+void recordBytesOut(size_t bytes);
+
+// Function to count a connection that was accepted
+void connectionOpened();
+
+// Function to count a connection that was closed
+void connectionClosed();
+
+// Function to handle the "Stats" command
+std::string formatStats();
+
+// Function to format all metrics in the Prometheus text format
+std::string formatPrometheus();
+
+// Function to serve the Prometheus metrics over HTTP on a local port, from a thread of its own
+bool startMetricsHttp(int port);
+
+#endif // METRICS_HPP
@@ -0,0 +1,101 @@
+#include "scc_trace.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+
+using namespace std;
+
+// Profiled queries kept for the "Trace" command, oldest first
+static const size_t MAX_RECENT_TRACES = 32;
+
+static deque<QueryTrace> recentTraces;
+static mutex recentMutex; // Protects recentTraces
+static atomic<int> nextThread(1); // Row numbers of the client threads in the Chrome trace
+
+#ifdef SCC_TRACE
+thread_local QueryTrace* activeTrace = nullptr;
+#endif
+
+// Function to get the steady clock in nanoseconds
+uint64_t traceNow() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Function to start profiling the queries of the calling thread into trace
+void beginTrace(QueryTrace& trace, const string& graph) {
+    static thread_local int thread = nextThread.fetch_add(1);
+    trace.graph = graph;
+    trace.thread = thread;
+    trace.spans.clear();
+    trace.spans.reserve(16); // No allocation inside the timed phases
+    trace.start = traceNow();
+#ifdef SCC_TRACE
+    activeTrace = &trace;
+#endif
+}
+
+// Function to stop profiling and keep the trace for the "Trace" command
+void endTrace(QueryTrace& trace) {
+    trace.duration = traceNow() - trace.start;
+#ifdef SCC_TRACE
+    activeTrace = nullptr;
+    lock_guard<mutex> lock(recentMutex);
+    recentTraces.push_back(trace);
+    if (recentTraces.size() > MAX_RECENT_TRACES) {
+        recentTraces.pop_front();
+    }
+#endif
+}
+
+// Function to format the per-phase breakdown of a query for the "Kosaraju profile" command
+string formatTrace(const QueryTrace& trace) {
+#ifdef SCC_TRACE
+    char line[128];
+    snprintf(line, sizeof(line), "Profile of Kosaraju on %s: %.1f us\n", trace.graph.c_str(), trace.duration / 1000.0);
+    string result = line;
+    uint64_t traced = 0;
+    for (const TraceSpan& span : trace.spans) {
+        snprintf(line, sizeof(line), "  %-12s %10.1f us %6.1f%%\n", span.name, span.duration / 1000.0,
+                 trace.duration ? 100.0 * span.duration / trace.duration : 0.0);
+        result += line;
+        traced += span.duration;
+    }
+    uint64_t other = trace.duration > traced ? trace.duration - traced : 0; // Dispatch and bookkeeping between the phases
+    snprintf(line, sizeof(line), "  %-12s %10.1f us %6.1f%%\n", "other", other / 1000.0,
+             trace.duration ? 100.0 * other / trace.duration : 0.0);
+    return result + line;
+#else
+    (void)trace;
+    return "Profiling is not compiled in, build with TRACE=1.\n";
+#endif
+}
+
+// Function to handle the "Trace" command: the recently profiled queries as Chrome trace JSON
+string formatChromeTrace() {
+#ifdef SCC_TRACE
+    char event[256];
+    string result = "{\"traceEvents\":[";
+    bool first = true;
+    lock_guard<mutex> lock(recentMutex);
+    for (const QueryTrace& trace : recentTraces) {
+        // The query itself, with its phases nested below it on the same row
+        snprintf(event, sizeof(event),
+                 "%s\n{\"name\":\"Kosaraju profile\",\"cat\":\"query\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                 "\"pid\":1,\"tid\":%d,\"args\":{\"graph\":\"%s\"}}",
+                 first ? "" : ",", trace.start / 1000.0, trace.duration / 1000.0, trace.thread, trace.graph.c_str());
+        result += event;
+        first = false;
+        for (const TraceSpan& span : trace.spans) {
+            snprintf(event, sizeof(event),
+                     ",\n{\"name\":\"%s\",\"cat\":\"scc\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                     span.name, (trace.start + span.start) / 1000.0, span.duration / 1000.0, trace.thread);
+            result += event;
+        }
+    }
+    return result + "\n],\"displayTimeUnit\":\"ns\"}\n";
+#else
+    return "Profiling is not compiled in, build with TRACE=1.\n";
+#endif
+}
@@ -0,0 +1,110 @@
+#ifndef SCC_TRACE_HPP
+#define SCC_TRACE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One timed phase of a profiled query
+struct TraceSpan {
+    const char* name;  // Phase name, a string literal
+    uint64_t start;    // Nanoseconds since the query started
+    uint64_t duration; // Nanoseconds
+};
+
+// Phases of one "Kosaraju profile" query, in the order they ended
+struct QueryTrace {
+    std::string graph;             // Graph the query ran on
+    uint64_t start = 0;            // Steady clock nanoseconds when the query started
+    uint64_t duration = 0;         // Nanoseconds from the start to endTrace()
+    int thread = 0;                // Client thread, one row of the Chrome trace per thread
+    std::vector<TraceSpan> spans;
+};
+
+// Function to get the steady clock in nanoseconds
+uint64_t traceNow();
+
+#ifdef SCC_TRACE
+
+// Trace the spans of the calling thread go to, nullptr while no query is profiled
+extern thread_local QueryTrace* activeTrace;
+
+// Times the enclosing scope into the active trace; costs one thread-local load while nothing is profiled
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : trace(activeTrace), name(name), start(trace ? traceNow() : 0) {}
+
+    ~TraceScope() {
+        if (trace) {
+            uint64_t end = traceNow();
+            trace->spans.push_back(TraceSpan{name, start - trace->start, end - start});
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    QueryTrace* trace;
+    const char* name;
+    uint64_t start;
+};
+
+// Times consecutive phases that have no scope of their own, such as the passes inside the SCC library
+class TracePhases {
+public:
+    TracePhases() : trace(activeTrace), name(nullptr), start(0) {}
+
+    ~TracePhases() { next(nullptr); }
+
+    TracePhases(const TracePhases&) = delete;
+    TracePhases& operator=(const TracePhases&) = delete;
+
+    // Ends the running phase and starts the next one; nullptr only ends it
+    void next(const char* phase) {
+        if (!trace) {
+            return;
+        }
+        uint64_t now = traceNow();
+        if (name) {
+            trace->spans.push_back(TraceSpan{name, start - trace->start, now - start});
+        }
+        name = phase;
+        start = now;
+    }
+
+private:
+    QueryTrace* trace;
+    const char* name;
+    uint64_t start;
+};
+
+#define SCC_TRACE_CONCAT2(a, b) a##b
+#define SCC_TRACE_CONCAT(a, b) SCC_TRACE_CONCAT2(a, b)
+#define SCC_TRACE_SPAN(name) TraceScope SCC_TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#else
+
+// Phases are not timed without SCC_TRACE
+class TracePhases {
+public:
+    void next(const char*) {}
+};
+
+#define SCC_TRACE_SPAN(name) do {} while (0)
+
+#endif // SCC_TRACE
+
+// Function to start profiling the queries of the calling thread into trace
+void beginTrace(QueryTrace& trace, const std::string& graph);
+
+// Function to stop profiling and keep the trace for the "Trace" command
+void endTrace(QueryTrace& trace);
+
+// Function to format the per-phase breakdown of a query for the "Kosaraju profile" command
+std::string formatTrace(const QueryTrace& trace);
+
+// Function to handle the "Trace" command: the recently profiled queries as Chrome trace JSON
+std::string formatChromeTrace();
+
+#endif // SCC_TRACE_HPP
@@ -16,75 +16,21 @@ using namespace std;
 
 // Global variables to store the graph and protect it with a mutex
 vector<list<int>> adj; // Adjacency list for the graph
-vector<list<int>> transposedAdj; // Transposed adjacency list for the graph
+scc::SCC<vector<list<int>>> sccSolver; // Kosaraju and its buffers, reused between queries
 int n, m; // Number of vertices and edges in the graph
 mutex graph_mutex; // Mutex to protect the graph data structure
 
-// Function to perform DFS and fill the stack
-void fillOrder(int v, vector<bool>& visited, stack<int>& Stack) {
-    visited[v] = true; // Mark the current node as visited
-    for (int neighbor : adj[v]) { // Iterate over all the adjacent vertices
-        if (!visited[neighbor]) { // If the adjacent vertex has not been visited
-            fillOrder(neighbor, visited, Stack); // Recursive call for the adjacent vertex
-        }
-    }
-    Stack.push(v); // Push the vertex to the stack after all its adjacent vertices are processed
-}
-
-// Function to perform DFS on the transposed graph
-void DFSUtil(int v, vector<bool>& visited, vector<int>& component) {
-    visited[v] = true; // Mark the current node as visited
-    component.push_back(v); // Add this vertex to the current component
-    for (int neighbor : transposedAdj[v]) { // Iterate over all the adjacent vertices in the transposed graph
-        if (!visited[neighbor]) { // If the adjacent vertex has not been visited
-            DFSUtil(neighbor, visited, component); // Recursive call for the adjacent vertex
-        }
-    }
-}
-
-// Function to get the transposed graph
-void getTranspose() {
-    transposedAdj = vector<list<int>>(n); // Create a transposed adjacency list with n vertices
-    for (int v = 0; v < n; ++v) { // Iterate over each vertex
-        for (int neighbor : adj[v]) { // Iterate over all the adjacent vertices
-            transposedAdj[neighbor].push_back(v); // Add an edge from neighbor to v in the transposed graph
-        }
-    }
-}
-
 // Function to find and return all strongly connected components (SCCs)
 string findSCCs() {
-    stack<int> Stack; // Stack to store the order of vertices by finishing times
-    vector<bool> visited(n, false); // Visited array to keep track of visited vertices
-
-    // Perform DFS to fill the stack with vertices in order of finishing times
-    for (int i = 0; i < n; ++i) {
-        if (!visited[i]) {
-            fillOrder(i, visited, Stack);
-        }
-    }
-
-    getTranspose(); // Get the transposed graph
-
-    fill(visited.begin(), visited.end(), false); // Mark all vertices as not visited for the second DFS
+    const scc::Components& sccs = sccSolver.run(adj); // Iterative Kosaraju of the shared SCC library
 
     stringstream ss; // String stream to store the SCCs result
-    int scc_count = 0; // Counter for SCCs
-
-    // Process all vertices in order defined by the stack
-    while (!Stack.empty()) {
-        int v = Stack.top();
-        Stack.pop();
-
-        if (!visited[v]) {
-            vector<int> component; // Vector to store the current SCC
-            DFSUtil(v, visited, component); // Perform DFS on the transposed graph
-            ss << "SCC " << ++scc_count << " is: ";
-            for (int vertex : component) {
-                ss << (vertex + 1) << " "; // Add vertices to the SCC result
-            }
-            ss << endl;
+    for (int i = 0; i < sccs.size(); ++i) {
+        ss << "SCC " << (i + 1) << " is: ";
+        for (const int* vertex = sccs.begin(i); vertex != sccs.end(i); ++vertex) {
+            ss << (*vertex + 1) << " "; // Add vertices to the SCC result
         }
+        ss << endl;
     }
 
     return ss.str(); // Return the result string
@@ -3,25 +3,16 @@
 
 #include <vector>
 #include <list>
-#include <stack>
 #include <mutex>
 #include <string>
+#include "../scc/scc.hpp"
 
 // Global variables for the graph and mutex for thread safety
 extern std::vector<std::list<int>> adj; // Adjacency list for the graph
-extern std::vector<std::list<int>> transposedAdj; // Transposed adjacency list for the graph
+extern scc::SCC<std::vector<std::list<int>>> sccSolver; // Kosaraju and its buffers, reused between queries
 extern int n, m; // Number of vertices and edges in the graph
 extern std::mutex graph_mutex; // Mutex to protect the graph data structure
 
-// Function to perform DFS and fill the stack
-void fillOrder(int v, std::vector<bool>& visited, std::stack<int>& Stack);
-
-// Function to perform DFS on the transposed graph
-void DFSUtil(int v, std::vector<bool>& visited, std::vector<int>& component);
-
-// Function to get the transposed graph
-void getTranspose();
-
 // Function to find and return all strongly connected components (SCCs)
 std::string findSCCs();
 
@@ -0,0 +1,20 @@
+#!/bin/sh
+# Runs the same load against the select, reactor, thread-per-client, proactor and adjacency-matrix servers
+# Usage: ./compare.sh [loadgen options]
+
+cd "$(dirname "$0")/.." || exit 1
+
+for server in Q4/kosaraju_server Q6/kosaraju_reactor Q7/kosaraju_server Q9/kosaraju_proactor Q10/kosaraju_server; do
+    if [ ! -x "$server" ]; then
+        echo "$server is not built, skipping"
+        continue
+    fi
+    "$server" > /dev/null 2>&1 &
+    pid=$!
+    sleep 0.5  # Let it bind the port
+    echo "== $server"
+    loadgen/loadgen "$@"
+    kill "$pid"
+    wait "$pid" 2> /dev/null
+    echo
+done
@@ -0,0 +1,404 @@
+// loadgen.cpp
+// Load generator for the Kosaraju servers (Q4, Q6, Q7, Q9, Q10). It opens N connections, builds a random graph,
+// then replays a weighted mix of Newgraph/Newedge/Removeedge/Kosaraju for a fixed time and reports the
+// throughput and the p50/p99/p99.9 latency of every command.
+//
+// Every connection has one request in flight at a time: Q7, Q9 and Q10 read one command per recv(), so
+// pipelined commands would be merged. In a closed loop the next request goes out as soon as the reply is in.
+// In an open loop (-r) the requests follow a Poisson schedule and the latency counts from the scheduled send
+// time, so a server that falls behind is charged for the queueing it causes.
+//
+// Replies of Newgraph and Kosaraju have a varying number of lines; their end is found by sending an invalid
+// command ("Ping") once the reply started and reading up to its "Invalid command" line.
+//
+// Usage: ./loadgen [-h host] [-p port] [-c connections] [-d seconds] [-w warm-up seconds] [-r requests/s]
+//                  [-n vertices] [-m edges] [-x newgraph=0,newedge=45,removeedge=45,kosaraju=10] [-s seed]
+
+#include "loadgen.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sstream>
+#include <strings.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+static const char* OPERATION_NAMES[OPERATIONS] = {"Newgraph", "Newedge", "Removeedge", "Kosaraju"};
+static const char* PROBE = "Ping\n";  // Invalid on every server, its reply marks the end of the one before
+static const char* PROBE_REPLY = "Invalid command";  // Q10 answers without the period
+
+static mutex startMutex;  // Holds the clients until all of them built their part of the graph
+static condition_variable startCond;
+static int clientsReady = 0;
+static bool started = false;
+static Clock::time_point measureStart;  // Requests scheduled before this are warm-up
+static Clock::time_point measureEnd;    // No request is scheduled after this
+
+// Function to print the usage of the tool
+static void usage(const char* program) {
+    cerr << "Usage: " << program << " [-h host] [-p port] [-c connections] [-d seconds] [-w warm-up seconds]"
+         << " [-r requests/s, 0 = closed loop] [-n vertices] [-m edges]"
+         << " [-x newgraph=0,newedge=45,removeedge=45,kosaraju=10] [-s seed]" << endl;
+}
+
+// Function to parse a command mix such as "newedge=50,kosaraju=50"; commands left out get weight 0
+static bool parseMix(const string& mix, unsigned weights[OPERATIONS]) {
+    fill(weights, weights + OPERATIONS, 0u);
+    stringstream ss(mix);
+    string item;
+    unsigned total = 0;
+    while (getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == string::npos) {
+            return false;
+        }
+        string name = item.substr(0, eq);
+        int op = 0;
+        while (op < OPERATIONS && strcasecmp(name.c_str(), OPERATION_NAMES[op]) != 0) {
+            ++op;
+        }
+        if (op == OPERATIONS) {
+            return false;
+        }
+        weights[op] = strtoul(item.c_str() + eq + 1, nullptr, 10);
+        total += weights[op];
+    }
+    return total > 0;
+}
+
+// Function to parse the command line; returns false if it is invalid
+bool parseOptions(int argc, char* argv[], Options& options) {
+    int opt;
+    while ((opt = getopt(argc, argv, "h:p:c:d:w:r:n:m:x:s:")) != -1) {
+        switch (opt) {
+            case 'h': options.host = optarg; break;
+            case 'p': options.port = optarg; break;
+            case 'c': options.connections = atoi(optarg); break;
+            case 'd': options.seconds = atof(optarg); break;
+            case 'w': options.warmup = atof(optarg); break;
+            case 'r': options.rate = atof(optarg); break;
+            case 'n': options.vertices = atoi(optarg); break;
+            case 'm': options.edges = atoi(optarg); break;
+            case 'x':
+                if (!parseMix(optarg, options.weights)) {
+                    return false;
+                }
+                break;
+            case 's': options.seed = strtoul(optarg, nullptr, 10); break;
+            default: return false;
+        }
+    }
+    return options.connections > 0 && options.seconds > 0 && options.warmup >= 0 && options.rate >= 0 &&
+           options.vertices > 0 && options.edges >= 0;
+}
+
+// Function to open a TCP connection to the server
+bool connectToServer(const Options& options, Connection& conn) {
+    struct addrinfo hints, *ai, *p;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int rv = getaddrinfo(options.host.c_str(), options.port.c_str(), &hints, &ai);
+    if (rv != 0) {
+        cerr << "loadgen: " << gai_strerror(rv) << endl;
+        return false;
+    }
+    for (p = ai; p != NULL; p = p->ai_next) {
+        conn.fd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if (conn.fd < 0) {
+            continue;
+        }
+        if (connect(conn.fd, p->ai_addr, p->ai_addrlen) == 0) {
+            break;
+        }
+        close(conn.fd);
+        conn.fd = -1;
+    }
+    freeaddrinfo(ai);
+    if (conn.fd < 0) {
+        perror("connect");
+        return false;
+    }
+    int yes = 1;
+    setsockopt(conn.fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(int));  // Requests are single small lines
+    struct timeval timeout;
+    timeout.tv_sec = options.timeoutMs / 1000;
+    timeout.tv_usec = (options.timeoutMs % 1000) * 1000;
+    setsockopt(conn.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));  // A stuck server fails the client
+    return true;
+}
+
+// Function to send a whole string
+static bool sendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += n;
+    }
+    return true;
+}
+
+// Function to receive whatever the server sent next into the input buffer
+static bool receiveMore(Connection& conn) {
+    char buf[65536];
+    ssize_t n = recv(conn.fd, buf, sizeof(buf), 0);
+    if (n <= 0) {
+        return false;  // Closed, broken or timed out
+    }
+    conn.lastRecv = Clock::now();
+    conn.input.append(buf, n);
+    return true;
+}
+
+// Function to take the next line out of the input buffer, receiving until one is complete
+static bool readLine(Connection& conn, string& line) {
+    size_t end;
+    while ((end = conn.input.find('\n')) == string::npos) {
+        if (!receiveMore(conn)) {
+            return false;
+        }
+    }
+    line.assign(conn.input, 0, end);
+    conn.input.erase(0, end + 1);
+    return true;
+}
+
+// Function to send one request and wait for its whole reply; sets the time the reply was complete
+bool request(Connection& conn, Operation op, const string& line, Clock::time_point& completed) {
+    if (!sendAll(conn.fd, line)) {
+        return false;
+    }
+    string reply;
+    if (op == OP_NEWEDGE || op == OP_REMOVEEDGE) {  // One line on every server
+        if (!readLine(conn, reply)) {
+            return false;
+        }
+        completed = conn.lastRecv;
+        return true;
+    }
+    // The probe goes out only once the reply started, so a server that reads one command per recv()
+    // still gets it on its own
+    if (conn.input.empty() && !receiveMore(conn)) {
+        return false;
+    }
+    completed = conn.lastRecv;
+    if (!sendAll(conn.fd, PROBE)) {
+        return false;
+    }
+    while (true) {
+        if (!readLine(conn, reply)) {
+            return false;
+        }
+        if (reply.find(PROBE_REPLY) != string::npos) {
+            return true;
+        }
+        completed = conn.lastRecv;  // The last line of the reply proper
+    }
+}
+
+// Function to build the request line of a command, keeping track of the edges this client owns
+static string makeRequest(Client& client, Operation op, const Options& options) {
+    uniform_int_distribution<int> vertex(1, options.vertices);
+    stringstream ss;
+    switch (op) {
+        case OP_NEWGRAPH:
+            ss << "Newgraph " << options.vertices << " 0\n";  // Edges would be merged by recv() on some servers
+            client.added.clear();
+            break;
+        case OP_NEWEDGE: {
+            pair<int, int> edge(vertex(client.rng), vertex(client.rng));
+            client.added.push_back(edge);
+            ss << "Newedge " << edge.first << " " << edge.second << "\n";
+            break;
+        }
+        case OP_REMOVEEDGE: {
+            pair<int, int> edge(vertex(client.rng), vertex(client.rng));  // Nothing left to remove: a miss
+            if (!client.added.empty()) {
+                size_t i = uniform_int_distribution<size_t>(0, client.added.size() - 1)(client.rng);
+                edge = client.added[i];
+                client.added[i] = client.added.back();
+                client.added.pop_back();
+            }
+            ss << "Removeedge " << edge.first << " " << edge.second << "\n";
+            break;
+        }
+        default:
+            ss << "Kosaraju\n";
+            break;
+    }
+    return ss.str();
+}
+
+// Function to pick the next command of the mix
+static Operation pickOperation(Client& client, const Options& options) {
+    unsigned total = 0;
+    for (int op = 0; op < OPERATIONS; ++op) {
+        total += options.weights[op];
+    }
+    unsigned r = uniform_int_distribution<unsigned>(0, total - 1)(client.rng);
+    int op = 0;
+    while (r >= options.weights[op]) {
+        r -= options.weights[op++];
+    }
+    return static_cast<Operation>(op);
+}
+
+// Function to run the closed- or open-loop request stream of one connection
+void runClient(Client& client, const Options& options) {
+    Clock::time_point completed;
+    int share = options.edges / options.connections;  // This client's part of the initial graph
+    for (int i = 0; i < share; ++i) {
+        if (!request(client.conn, OP_NEWEDGE, makeRequest(client, OP_NEWEDGE, options), completed)) {
+            ++client.errors;
+            break;
+        }
+    }
+    {
+        unique_lock<mutex> lock(startMutex);
+        ++clientsReady;
+        startCond.notify_all();
+        startCond.wait(lock, [] { return started; });
+    }
+
+    double perClient = options.rate / options.connections;
+    exponential_distribution<double> gap(perClient > 0 ? perClient : 1);
+    Clock::time_point scheduled = Clock::now();
+    while (client.errors == 0) {
+        if (perClient > 0) {  // Open loop: the next send time does not depend on the replies
+            scheduled += chrono::duration_cast<Clock::duration>(chrono::duration<double>(gap(client.rng)));
+            this_thread::sleep_until(scheduled);
+        } else {
+            scheduled = Clock::now();
+        }
+        if (scheduled >= measureEnd) {
+            break;
+        }
+        if (Clock::now() >= measureEnd) {  // Saturated: the rest of the schedule never went out
+            while (scheduled < measureEnd) {
+                ++client.unsent;
+                scheduled += chrono::duration_cast<Clock::duration>(chrono::duration<double>(gap(client.rng)));
+            }
+            break;
+        }
+        Operation op = pickOperation(client, options);
+        if (!request(client.conn, op, makeRequest(client, op, options), completed)) {
+            ++client.errors;
+            break;
+        }
+        if (scheduled >= measureStart) {
+            client.latencies[op].push_back(chrono::duration_cast<chrono::nanoseconds>(completed - scheduled).count());
+        }
+    }
+}
+
+// Function to get a percentile of sorted latencies in microseconds
+static double percentile(const vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>(p * sorted.size());
+    return sorted[min(rank, sorted.size() - 1)] / 1000.0;
+}
+
+// Function to print one row of the report
+static void printRow(const char* name, vector<uint64_t>& latencies, double seconds) {
+    sort(latencies.begin(), latencies.end());
+    printf("%-11s %10zu %12.1f %10.1f %10.1f %10.1f %10.1f\n", name, latencies.size(), latencies.size() / seconds,
+           percentile(latencies, 0.50), percentile(latencies, 0.99), percentile(latencies, 0.999),
+           latencies.empty() ? 0.0 : latencies.back() / 1000.0);
+}
+
+// Function to print throughput and latency percentiles of all clients
+void printReport(const vector<Client>& clients, const Options& options) {
+    vector<uint64_t> merged[OPERATIONS];
+    vector<uint64_t> all;
+    uint64_t errors = 0;
+    uint64_t unsent = 0;
+    for (const Client& client : clients) {
+        for (int op = 0; op < OPERATIONS; ++op) {
+            merged[op].insert(merged[op].end(), client.latencies[op].begin(), client.latencies[op].end());
+            all.insert(all.end(), client.latencies[op].begin(), client.latencies[op].end());
+        }
+        errors += client.errors;
+        unsent += client.unsent;
+    }
+    printf("%s:%s, %d connections, %s, %.1f s measured after %.1f s warm-up, %d vertices, %d edges\n",
+           options.host.c_str(), options.port.c_str(), options.connections,
+           options.rate > 0 ? ("open loop at " + to_string((long)options.rate) + " requests/s").c_str() : "closed loop",
+           options.seconds, options.warmup, options.vertices, options.edges);
+    printf("%-11s %10s %12s %10s %10s %10s %10s\n", "Command", "Requests", "Requests/s", "p50 us", "p99 us",
+           "p99.9 us", "max us");
+    for (int op = 0; op < OPERATIONS; ++op) {
+        if (options.weights[op] > 0) {
+            printRow(OPERATION_NAMES[op], merged[op], options.seconds);
+        }
+    }
+    printRow("All", all, options.seconds);
+    if (unsent > 0) {
+        printf("%llu scheduled requests were not sent before the end: the server could not keep up\n",
+               (unsigned long long)unsent);
+    }
+    if (errors > 0) {
+        printf("%llu connections failed (closed, broken or timed out)\n", (unsigned long long)errors);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    vector<Client> clients(options.connections);
+    for (int i = 0; i < options.connections; ++i) {
+        if (!connectToServer(options, clients[i].conn)) {
+            return 1;
+        }
+        clients[i].rng.seed(options.seed + i);
+    }
+    Clock::time_point completed;
+    stringstream newGraph;
+    newGraph << "Newgraph " << options.vertices << " 0\n";
+    if (!request(clients[0].conn, OP_NEWGRAPH, newGraph.str(), completed)) {  // One graph shared by all clients
+        cerr << "loadgen: no reply to Newgraph" << endl;
+        return 1;
+    }
+
+    vector<thread> threads;
+    for (Client& client : clients) {
+        threads.push_back(thread(runClient, ref(client), cref(options)));
+    }
+    {
+        unique_lock<mutex> lock(startMutex);
+        startCond.wait(lock, [&] { return clientsReady == options.connections; });  // The graph is complete
+        Clock::time_point now = Clock::now();
+        measureStart = now + chrono::duration_cast<Clock::duration>(chrono::duration<double>(options.warmup));
+        measureEnd = measureStart + chrono::duration_cast<Clock::duration>(chrono::duration<double>(options.seconds));
+        started = true;
+        startCond.notify_all();
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    for (Client& client : clients) {
+        close(client.conn.fd);
+    }
+
+    printReport(clients, options);
+    return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef LOADGEN_HPP
+#define LOADGEN_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+// Commands the load generator sends
+enum Operation { OP_NEWGRAPH, OP_NEWEDGE, OP_REMOVEEDGE, OP_KOSARAJU, OPERATIONS };
+
+// Settings of one run, from the command line
+struct Options {
+    std::string host = "127.0.0.1";
+    std::string port = "9034";
+    int connections = 8;           // Client connections, one thread each
+    double seconds = 10;           // Length of the measured phase
+    double warmup = 1;             // Seconds run before measuring
+    double rate = 0;               // Requests per second of all connections together, 0 for a closed loop
+    int vertices = 1000;           // Vertices of the graph
+    int edges = 4000;              // Edges added before the run
+    unsigned weights[OPERATIONS];  // Share of each command in the mix
+    unsigned seed = 1;             // Seed of the random commands and arrival times
+    int timeoutMs = 10000;         // A reply slower than this fails the connection
+
+    Options() : weights{0, 45, 45, 10} {}
+};
+
+// One client connection with the bytes received but not consumed yet
+struct Connection {
+    int fd = -1;
+    std::string input;
+    Clock::time_point lastRecv;  // When the last bytes of the input arrived
+};
+
+// Work and results of one connection's thread
+struct Client {
+    Connection conn;
+    std::mt19937 rng;
+    std::vector<std::pair<int, int>> added;       // Edges this client added and may remove
+    std::vector<uint64_t> latencies[OPERATIONS];  // Nanoseconds of every measured request
+    uint64_t unsent = 0;  // Open loop: requests scheduled before the end but never sent
+    uint64_t errors = 0;
+};
+
+// Function to parse the command line; returns false if it is invalid
+bool parseOptions(int argc, char* argv[], Options& options);
+
+// Function to open a TCP connection to the server
+bool connectToServer(const Options& options, Connection& conn);
+
+// Function to send one request and wait for its whole reply; sets the time the reply was complete
+bool request(Connection& conn, Operation op, const std::string& line, Clock::time_point& completed);
+
+// Function to run the closed- or open-loop request stream of one connection
+void runClient(Client& client, const Options& options);
+
+// Function to print throughput and latency percentiles of all clients
+void printReport(const std::vector<Client>& clients, const Options& options);
+
+#endif // LOADGEN_HPP
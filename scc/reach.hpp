@@ -0,0 +1,169 @@
+#ifndef SCC_REACH_HPP
+#define SCC_REACH_HPP
+
+// Single-source reachability on any graph the SCC library supports: which vertices a source reaches.
+//
+// scc::ReachBFS runs a direction-optimizing breadth-first search (Beamer et al.). Top-down levels scan
+// the out-edges of the frontier; once the frontier is a large part of what is left, bottom-up levels
+// instead let every unvisited vertex scan its in-edges for a frontier vertex and stop at the first one.
+// It therefore needs the graph and its transpose, e.g. the rows a server keeps and a transposeCSR.
+// "Reached by" is the same search with the two swapped. Levels with enough work are split over
+// setThreads() threads with parallelFor, like transposeCSR; the visited set is a word bitmap.
+
+#include "scc.hpp"
+
+namespace scc {
+
+// Top-down levels switch to bottom-up once the frontier is more than 1/BFS_ALPHA of the unvisited
+// vertices, and back once a shrinking frontier is less than 1/BFS_BETA of all vertices. Beamer compares
+// edge counts; rows like lists have no O(1) degree, so the vertex counts stand in for them.
+const int BFS_ALPHA = 14;
+const int BFS_BETA = 24;
+
+// Levels with fewer frontier (top-down) or unvisited (bottom-up) vertices run on the caller's thread
+const int BFS_PARALLEL_VERTICES = 1 << 14;
+
+class ReachBFS {
+public:
+    // Number of threads of the large levels (1, the default, stays on the caller's)
+    void setThreads(int count) { threads = std::max(1, count); }
+
+    // Function to find the vertices source reaches along the edges of forward; backward holds the same
+    // edges reversed. Returns how many there are, source included.
+    template <typename Forward, typename Backward>
+    int run(const Forward& forward, const Backward& backward, int source) {
+        n = GraphTraits<Forward>::vertexCount(forward);
+        int words = (n + 63) / 64;
+        visited.assign(words, 0);
+        visited[source >> 6] |= uint64_t(1) << (source & 63);
+        frontier.assign(1, source);
+        topDownLevels = bottomUpLevels = 0;
+        int reachedCount = 1, frontierSize = 1, previousSize = 0;
+        bool bottomUp = false;
+        while (frontierSize > 0) {
+            int unvisited = n - reachedCount;
+            if (!bottomUp && frontierSize > unvisited / BFS_ALPHA) {
+                toBits(words);
+                bottomUp = true;
+            } else if (bottomUp && frontierSize < n / BFS_BETA && frontierSize < previousSize) {
+                toQueue();
+                bottomUp = false;
+            }
+            previousSize = frontierSize;
+            frontierSize = bottomUp ? stepBottomUp(backward, unvisited) : stepTopDown(forward);
+            reachedCount += frontierSize;
+        }
+        return reachedCount;
+    }
+
+    // Visited set of the last run: vertex v is bit v % 64 of word v / 64
+    const std::vector<uint64_t>& reached() const { return visited; }
+
+    bool reaches(int v) const { return (visited[v >> 6] >> (v & 63)) & 1; }
+
+    int topDownLevels = 0, bottomUpLevels = 0;  // Levels of the last run in each direction
+
+private:
+    int n = 0;
+    int threads = 1;
+    std::vector<uint64_t> visited;
+    std::vector<int> frontier;                     // Top-down: the frontier as a queue
+    std::vector<std::vector<int>> nextFrontiers;   // Top-down: what every thread found
+    std::vector<uint64_t> frontierBits, nextBits;  // Bottom-up: the frontier as a bitmap
+
+    int levelThreads(int work) const { return work >= BFS_PARALLEL_VERTICES ? std::min(threads, work) : 1; }
+
+    // Function to take one top-down level; every thread claims vertices with an atomic or on the bitmap
+    template <typename Forward>
+    int stepTopDown(const Forward& forward) {
+        typedef GraphTraits<Forward> Traits;
+        ++topDownLevels;
+        int count = levelThreads(static_cast<int>(frontier.size()));
+        nextFrontiers.resize(count);
+        parallelFor(count, [&](int t) {
+            std::vector<int>& next = nextFrontiers[t];
+            next.clear();
+            size_t first = frontier.size() * t / count, last = frontier.size() * (t + 1) / count;
+            for (size_t i = first; i < last; ++i) {
+                int v = frontier[i];
+                for (typename Traits::Iterator it = Traits::begin(forward, v), end = Traits::end(forward, v); it != end;
+                     ++it) {
+                    int w = *it;
+                    uint64_t bit = uint64_t(1) << (w & 63);
+                    if (__atomic_load_n(&visited[w >> 6], __ATOMIC_RELAXED) & bit) {
+                        continue;
+                    }
+                    if (count == 1) {
+                        visited[w >> 6] |= bit;
+                    } else if (__atomic_fetch_or(&visited[w >> 6], bit, __ATOMIC_RELAXED) & bit) {
+                        continue;  // Another thread claimed w first
+                    }
+                    next.push_back(w);
+                }
+            }
+        });
+        frontier.swap(nextFrontiers[0]);
+        for (int t = 1; t < count; ++t) {
+            frontier.insert(frontier.end(), nextFrontiers[t].begin(), nextFrontiers[t].end());
+        }
+        return static_cast<int>(frontier.size());
+    }
+
+    // Function to take one bottom-up level; every thread owns a range of bitmap words, so no atomics
+    template <typename Backward>
+    int stepBottomUp(const Backward& backward, int unvisited) {
+        typedef GraphTraits<Backward> Traits;
+        ++bottomUpLevels;
+        int words = static_cast<int>(visited.size());
+        nextBits.assign(words, 0);
+        int count = std::min(levelThreads(unvisited), words);
+        std::vector<int> found(count, 0);
+        parallelFor(count, [&](int t) {
+            for (int i = words * t / count, last = words * (t + 1) / count; i < last; ++i) {
+                uint64_t open = ~visited[i];
+                if (i == words - 1 && (n & 63)) {
+                    open &= (uint64_t(1) << (n & 63)) - 1;  // No vertices past n
+                }
+                for (; open; open &= open - 1) {
+                    int w = i * 64 + __builtin_ctzll(open);
+                    for (typename Traits::Iterator it = Traits::begin(backward, w), end = Traits::end(backward, w);
+                         it != end; ++it) {
+                        int u = *it;
+                        if ((frontierBits[u >> 6] >> (u & 63)) & 1) {  // One parent in the frontier is enough
+                            nextBits[i] |= uint64_t(1) << (w & 63);
+                            break;
+                        }
+                    }
+                }
+                visited[i] |= nextBits[i];
+                found[t] += __builtin_popcountll(nextBits[i]);
+            }
+        });
+        frontierBits.swap(nextBits);
+        int total = 0;
+        for (int added : found) {
+            total += added;
+        }
+        return total;
+    }
+
+    void toBits(int words) {
+        frontierBits.assign(words, 0);
+        for (int v : frontier) {
+            frontierBits[v >> 6] |= uint64_t(1) << (v & 63);
+        }
+    }
+
+    void toQueue() {
+        frontier.clear();
+        for (size_t i = 0; i < frontierBits.size(); ++i) {
+            for (uint64_t bits = frontierBits[i]; bits; bits &= bits - 1) {
+                frontier.push_back(static_cast<int>(i * 64 + __builtin_ctzll(bits)));
+            }
+        }
+    }
+};
+
+} // namespace scc
+
+#endif // SCC_REACH_HPP
@@ -0,0 +1,869 @@
+#ifndef SCC_HPP
+#define SCC_HPP
+
+// Header-only strongly connected components library shared by Q1-Q10.
+//
+// A graph is anything GraphTraits is specialized for: it gives the vertex count (vertices are 0 .. n-1)
+// and a range of neighbors per vertex. The neighbor iterator only needs copying, *it (an int vertex),
+// ++it and it != end. Ready-made adapters cover the containers the exercises use:
+//   std::vector<C>          vector of any int sequence (vector, list, deque), e.g. vector<list<int>>
+//   scc::IndexedGraph<O>    any outer container, e.g. list<list<int>>, indexed once so lookups are O(1)
+//   scc::MapGraph<M>        map or unordered_map from vertex to neighbors; missing keys have no edges
+//   scc::MatrixGraph        n x n 0/1 adjacency matrix, optionally the subgraph induced by some rows
+//   scc::CSRView<O, T>      compressed sparse row arrays (row offsets, targets), also memory-mapped ones
+//
+// scc::SCC<Graph, Algorithm> runs an iterative engine, so deep graphs do not overflow the call stack:
+//   scc::Kosaraju  two passes; the transpose is built once as CSR, whatever the input container is
+//                  (transposeCSR, radix-partitioned and on setTransposeThreads threads for large graphs).
+//                  Components and their vertices come out in the same order as the recursive
+//                  fillOrder/DFSUtil code this library replaces.
+//   scc::Tarjan    one pass and no transpose; components come out in reverse topological order.
+// Kosaraju on graphs of up to SMALL_GRAPH_VERTICES vertices runs a bitset kernel instead (bitKosaraju,
+// one 64-bit word per row up to 64 vertices, four up to 256). It finds the same components in the same
+// order whenever the neighbor lists are ascending, but lists the vertices of each in ascending order.
+// The Kosaraju passes keep their visited marks in a word bitmap (BitMarks, or ByteMarks as the third
+// template parameter) and prefetch the marks and rows of the neighbors ahead on CSR and vector rows.
+// Visitors (see NoVisitor) observe the phases and the components, and can cancel a run; they are
+// template parameters, so an empty visitor costs nothing.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace scc {
+
+// Graph concept, specialized for every supported representation
+template <typename Graph>
+struct GraphTraits;
+
+// Vector of neighbor sequences: vector<vector<int>>, vector<list<int>>, vector<deque<int>>, ...
+// (an adjacency matrix stored as vector<vector<int>> needs MatrixGraph instead)
+template <typename Container, typename Allocator>
+struct GraphTraits<std::vector<Container, Allocator>> {
+    typedef typename Container::const_iterator Iterator;
+    static int vertexCount(const std::vector<Container, Allocator>& g) { return static_cast<int>(g.size()); }
+    static Iterator begin(const std::vector<Container, Allocator>& g, int v) { return g[v].begin(); }
+    static Iterator end(const std::vector<Container, Allocator>& g, int v) { return g[v].end(); }
+};
+
+// Any outer container of neighbor sequences, indexed once; makes list<list<int>> usable in O(1) per vertex
+template <typename Outer>
+class IndexedGraph {
+public:
+    typedef typename Outer::value_type Inner;
+
+    explicit IndexedGraph(const Outer& outer) {
+        rows.reserve(outer.size());
+        for (const Inner& row : outer) {
+            rows.push_back(&row);
+        }
+    }
+
+    int vertexCount() const { return static_cast<int>(rows.size()); }
+    const Inner& operator[](int v) const { return *rows[v]; }
+
+private:
+    std::vector<const Inner*> rows;
+};
+
+template <typename Outer>
+struct GraphTraits<IndexedGraph<Outer>> {
+    typedef typename IndexedGraph<Outer>::Inner::const_iterator Iterator;
+    static int vertexCount(const IndexedGraph<Outer>& g) { return g.vertexCount(); }
+    static Iterator begin(const IndexedGraph<Outer>& g, int v) { return g[v].begin(); }
+    static Iterator end(const IndexedGraph<Outer>& g, int v) { return g[v].end(); }
+};
+
+// Map from vertex to neighbors with n vertices 0 .. n-1; vertices without a key have no outgoing edges
+template <typename Map>
+struct MapGraph {
+    const Map* adj;
+    int n;
+
+    MapGraph(const Map& adj, int n) : adj(&adj), n(n) {}
+};
+
+template <typename Map>
+struct GraphTraits<MapGraph<Map>> {
+    typedef typename Map::mapped_type Inner;
+    typedef typename Inner::const_iterator Iterator;
+    static int vertexCount(const MapGraph<Map>& g) { return g.n; }
+    static Iterator begin(const MapGraph<Map>& g, int v) { return row(g, v).begin(); }
+    static Iterator end(const MapGraph<Map>& g, int v) { return row(g, v).end(); }
+
+private:
+    static const Inner& row(const MapGraph<Map>& g, int v) {
+        static const Inner empty;  // Shared by all vertices without a key
+        typename Map::const_iterator it = g.adj->find(v);
+        return it == g.adj->end() ? empty : it->second;
+    }
+};
+
+// 0/1 adjacency matrix. With members, the subgraph induced by those rows: vertex i stands for members[i].
+struct MatrixGraph {
+    const std::vector<std::vector<int>>* matrix;
+    const std::vector<int>* members;  // nullptr for the whole matrix
+
+    explicit MatrixGraph(const std::vector<std::vector<int>>& matrix, const std::vector<int>* members = nullptr)
+        : matrix(&matrix), members(members) {}
+
+    int vertexCount() const { return static_cast<int>(members ? members->size() : matrix->size()); }
+    int row(int v) const { return members ? (*members)[v] : v; }
+
+    // Walks a row and stops at the nonzero entries
+    class Iterator {
+    public:
+        Iterator(const MatrixGraph* g, int v, int column) : g(g), entries(&(*g->matrix)[g->row(v)]), column(column) {
+            skipZeros();
+        }
+        int operator*() const { return column; }
+        Iterator& operator++() {
+            ++column;
+            skipZeros();
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return column == other.column; }
+        bool operator!=(const Iterator& other) const { return column != other.column; }
+
+    private:
+        const MatrixGraph* g;
+        const std::vector<int>* entries;
+        int column;
+
+        void skipZeros() {
+            int n = g->vertexCount();
+            while (column < n && !(*entries)[g->row(column)]) {
+                ++column;
+            }
+        }
+    };
+};
+
+template <>
+struct GraphTraits<MatrixGraph> {
+    typedef MatrixGraph::Iterator Iterator;
+    static int vertexCount(const MatrixGraph& g) { return g.vertexCount(); }
+    static Iterator begin(const MatrixGraph& g, int v) { return Iterator(&g, v, 0); }
+    static Iterator end(const MatrixGraph& g, int v) { return Iterator(&g, v, g.vertexCount()); }
+};
+
+// Compressed sparse row arrays: the neighbors of v are targets[offsets[v]] .. targets[offsets[v + 1] - 1]
+template <typename Offset = int, typename Target = int>
+struct CSRView {
+    int n;
+    const Offset* offsets;
+    const Target* targets;
+
+    CSRView(int n, const Offset* offsets, const Target* targets) : n(n), offsets(offsets), targets(targets) {}
+};
+
+template <typename Offset, typename Target>
+struct GraphTraits<CSRView<Offset, Target>> {
+    typedef const Target* Iterator;
+    static int vertexCount(const CSRView<Offset, Target>& g) { return g.n; }
+    static Iterator begin(const CSRView<Offset, Target>& g, int v) { return g.targets + g.offsets[v]; }
+    static Iterator end(const CSRView<Offset, Target>& g, int v) { return g.targets + g.offsets[v + 1]; }
+};
+
+// Transposes are built bucket by bucket, each bucket a range of at least 2^TRANSPOSE_BUCKET_BITS
+// target vertices, and with at most TRANSPOSE_MAX_BUCKETS buckets
+const int TRANSPOSE_BUCKET_BITS = 12;
+const int TRANSPOSE_MAX_BUCKETS = 1024;
+
+// Function to run work(0) .. work(threads - 1), all but the first on threads of their own
+template <typename Work>
+void parallelFor(int threads, Work work) {
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.push_back(std::thread(work, t));
+    }
+    work(0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// Function to build the transpose of any Graph as CSR arrays; every row lists its sources in
+// increasing order. Small graphs get one counting sort. Larger ones are radix-partitioned first:
+// the edges are histogrammed and scattered into buckets of target vertices (a few hundred sequential
+// write streams instead of one random write per edge), then every bucket is counting-sorted on its
+// own, with its row offsets and its part of targets small enough to stay in cache. Source ranges
+// and buckets are split over the given number of threads; scratch holds the partitioned edges.
+template <typename Graph>
+void transposeCSR(const Graph& g, std::vector<int>& offsets, std::vector<int>& targets, int threads,
+                  std::vector<std::pair<int, int>>& scratch) {
+    typedef GraphTraits<Graph> Traits;
+    typedef typename Traits::Iterator Iterator;
+    int n = Traits::vertexCount(g);
+    int shift = TRANSPOSE_BUCKET_BITS;
+    while (n > 0 && ((n - 1) >> shift) >= TRANSPOSE_MAX_BUCKETS) {
+        ++shift;
+    }
+    int buckets = n > 0 ? ((n - 1) >> shift) + 1 : 1;
+    offsets.assign(n + 1, 0);
+
+    if (buckets == 1) {  // All the row offsets fit in cache, scatter directly
+        for (int v = 0; v < n; ++v) {
+            for (Iterator it = Traits::begin(g, v), last = Traits::end(g, v); it != last; ++it) {
+                ++offsets[*it + 1];
+            }
+        }
+        for (int v = 0; v < n; ++v) {
+            offsets[v + 1] += offsets[v];
+        }
+        targets.resize(offsets[n]);
+        std::vector<int> next(offsets.begin(), offsets.end() - 1);  // Next free slot of every row
+        for (int v = 0; v < n; ++v) {
+            for (Iterator it = Traits::begin(g, v), last = Traits::end(g, v); it != last; ++it) {
+                targets[next[*it]++] = v;
+            }
+        }
+        return;
+    }
+
+    threads = std::max(1, std::min(threads, n));
+    std::vector<int> slots(threads * buckets, 0);  // Edges of source range t in bucket b, then where they go
+    parallelFor(threads, [&](int t) {  // Histogram of the buckets, private per thread
+        int* count = slots.data() + t * buckets;
+        for (int v = static_cast<long long>(n) * t / threads, last = static_cast<long long>(n) * (t + 1) / threads;
+             v < last; ++v) {
+            for (Iterator it = Traits::begin(g, v), end = Traits::end(g, v); it != end; ++it) {
+                ++count[*it >> shift];
+            }
+        }
+    });
+    std::vector<int> bucketFirst(buckets + 1);  // Buckets in order, each holding its source ranges in order
+    int edges = 0;
+    for (int b = 0; b < buckets; ++b) {
+        bucketFirst[b] = edges;
+        for (int t = 0; t < threads; ++t) {
+            int count = slots[t * buckets + b];
+            slots[t * buckets + b] = edges;
+            edges += count;
+        }
+    }
+    bucketFirst[buckets] = edges;
+
+    scratch.resize(edges);
+    parallelFor(threads, [&](int t) {  // Partition the edges (target, source) by bucket
+        int* next = slots.data() + t * buckets;
+        for (int v = static_cast<long long>(n) * t / threads, last = static_cast<long long>(n) * (t + 1) / threads;
+             v < last; ++v) {
+            for (Iterator it = Traits::begin(g, v), end = Traits::end(g, v); it != end; ++it) {
+                scratch[next[*it >> shift]++] = std::make_pair(static_cast<int>(*it), v);
+            }
+        }
+    });
+
+    targets.resize(edges);
+    parallelFor(threads, [&](int t) {  // Counting sort of every bucket; bucket b owns offsets[lo + 1 .. hi]
+        std::vector<int> next;
+        for (int b = t; b < buckets; b += threads) {
+            int lo = b << shift, hi = std::min(n, lo + (1 << shift));
+            next.assign(hi - lo, 0);
+            for (int e = bucketFirst[b]; e < bucketFirst[b + 1]; ++e) {
+                ++next[scratch[e].first - lo];
+            }
+            int slot = bucketFirst[b];
+            for (int v = lo; v < hi; ++v) {  // In-degrees become the first slot of every row
+                int count = next[v - lo];
+                next[v - lo] = slot;
+                slot += count;
+                offsets[v + 1] = slot;
+            }
+            for (int e = bucketFirst[b]; e < bucketFirst[b + 1]; ++e) {
+                targets[next[scratch[e].first - lo]++] = scratch[e].second;
+            }
+        }
+    });
+}
+
+// Algorithms
+struct Kosaraju {};
+struct Tarjan {};
+
+// Stages a visitor is told about
+enum Phase { FIRST_PASS, TRANSPOSE, SECOND_PASS, DONE };
+
+// Function to get the name of a phase, for profiles and traces
+inline const char* phaseName(Phase phase) {
+    static const char* names[] = {"first pass", "transpose", "second pass", "done"};
+    return names[phase];
+}
+
+// Visitor that observes nothing; custom visitors derive from it and hide what they need
+struct NoVisitor {
+    bool cancelled() const { return false; }       // Polled before every new vertex; true ends the run early
+    void phase(Phase) {}                            // Called when a stage starts
+    void component(const int*, const int*) {}       // Called with the vertices of every component found
+};
+
+// Components in the order the algorithm found them
+struct Components {
+    std::vector<int> vertices;  // Vertices of all components, one component after the other
+    std::vector<int> offsets;   // Component c is vertices[offsets[c]] .. vertices[offsets[c + 1] - 1]
+
+    Components() : offsets(1, 0) {}
+
+    int size() const { return static_cast<int>(offsets.size()) - 1; }
+    const int* begin(int c) const { return vertices.data() + offsets[c]; }
+    const int* end(int c) const { return vertices.data() + offsets[c + 1]; }
+    int componentSize(int c) const { return offsets[c + 1] - offsets[c]; }
+
+    void clear() {
+        vertices.clear();
+        offsets.assign(1, 0);
+    }
+
+    // One vector per component, for code that keeps vector<vector<int>>
+    std::vector<std::vector<int>> toVectors() const {
+        std::vector<std::vector<int>> result(size());
+        for (int c = 0; c < size(); ++c) {
+            result[c].assign(begin(c), end(c));
+        }
+        return result;
+    }
+};
+
+// Graphs with at most this many vertices go to the bitset kernel when Kosaraju is asked for
+const int SMALL_GRAPH_VERTICES = 256;
+
+// Fixed-size vertex set of a small graph, 64 vertices per word; with one word it lives in a register
+template <int Words>
+struct Bits {
+    uint64_t words[Words];
+
+    void clear() {
+        for (int i = 0; i < Words; ++i) {
+            words[i] = 0;
+        }
+    }
+    void set(int v) { words[v >> 6] |= uint64_t(1) << (v & 63); }
+    bool test(int v) const { return (words[v >> 6] >> (v & 63)) & 1; }
+
+    bool empty() const {
+        uint64_t any = 0;
+        for (int i = 0; i < Words; ++i) {
+            any |= words[i];
+        }
+        return any == 0;
+    }
+
+    // Lowest vertex of this set that is not in other, -1 if there is none
+    int firstNotIn(const Bits& other) const {
+        for (int i = 0; i < Words; ++i) {
+            uint64_t word = words[i] & ~other.words[i];
+            if (word) {
+                return i * 64 + __builtin_ctzll(word);
+            }
+        }
+        return -1;
+    }
+};
+
+// Kosaraju for graphs of at most 64 * Words vertices on bit-row adjacency matrices kept on the stack.
+// The first pass follows the lowest unvisited neighbor of the DFS top (one ctz per step); the second
+// pass grows every component a whole frontier at a time by OR-ing transposed rows, so it costs one
+// row operation per vertex instead of one visit per edge. Components come out in Kosaraju order for
+// ascending neighbor lists, each listing its vertices in ascending order.
+// Returns false if the visitor cancelled the run.
+template <int Words, typename Graph, typename Visitor>
+bool bitKosaraju(const Graph& g, int n, const std::vector<char>& excluded, Visitor& visitor, Components& result) {
+    typedef GraphTraits<Graph> Traits;
+    Bits<Words> adj[64 * Words], transposed[64 * Words];
+    for (int v = 0; v < n; ++v) {
+        adj[v].clear();
+        transposed[v].clear();
+    }
+    for (int v = 0; v < n; ++v) {  // Parallel edges fall together into one bit
+        for (typename Traits::Iterator it = Traits::begin(g, v), last = Traits::end(g, v); it != last; ++it) {
+            adj[v].set(*it);
+            transposed[*it].set(v);
+        }
+    }
+    Bits<Words> visited;
+    visited.clear();
+    for (int v = 0; v < n; ++v) {
+        if (excluded[v]) {
+            visited.set(v);
+        }
+    }
+    Bits<Words> assigned = visited;  // Second pass: vertices in a component already, or excluded
+
+    visitor.phase(FIRST_PASS);
+    int order[64 * Words], finished = 0;  // Vertices by finishing time
+    int stack[64 * Words];
+    for (int s = 0; s < n; ++s) {
+        if (visited.test(s)) {
+            continue;
+        }
+        if (visitor.cancelled()) {
+            return false;
+        }
+        visited.set(s);
+        stack[0] = s;
+        int depth = 1;
+        while (depth > 0) {
+            int v = stack[depth - 1];
+            int w = adj[v].firstNotIn(visited);
+            if (w >= 0) {
+                visited.set(w);
+                stack[depth++] = w;
+            } else {
+                order[finished++] = v;  // All neighbors are processed
+                --depth;
+            }
+        }
+    }
+
+    visitor.phase(SECOND_PASS);
+    for (int i = finished - 1; i >= 0; --i) {
+        int s = order[i];
+        if (assigned.test(s)) {
+            continue;
+        }
+        if (visitor.cancelled()) {
+            return false;
+        }
+        Bits<Words> component, frontier;  // Everything left that reaches s
+        component.clear();
+        component.set(s);
+        frontier = component;
+        while (!frontier.empty()) {
+            Bits<Words> next;
+            next.clear();
+            for (int word = 0; word < Words; ++word) {
+                for (uint64_t bits = frontier.words[word]; bits; bits &= bits - 1) {
+                    const Bits<Words>& row = transposed[word * 64 + __builtin_ctzll(bits)];
+                    for (int j = 0; j < Words; ++j) {
+                        next.words[j] |= row.words[j];
+                    }
+                }
+            }
+            for (int j = 0; j < Words; ++j) {
+                frontier.words[j] = next.words[j] & ~component.words[j] & ~assigned.words[j];
+                component.words[j] |= frontier.words[j];
+            }
+        }
+        int first = result.offsets.back();
+        for (int word = 0; word < Words; ++word) {
+            assigned.words[word] |= component.words[word];
+            for (uint64_t bits = component.words[word]; bits; bits &= bits - 1) {
+                result.vertices.push_back(word * 64 + __builtin_ctzll(bits));
+            }
+        }
+        result.offsets.push_back(static_cast<int>(result.vertices.size()));
+        visitor.component(result.vertices.data() + first, result.vertices.data() + result.vertices.size());
+    }
+    return true;
+}
+
+// Visited marks of the Kosaraju passes, the third template parameter of SCC. ByteMarks spends a byte
+// per vertex and a plain load or store per access; BitMarks packs 64 vertices into a word, so the
+// marks of a large graph take an eighth of the cache, for a shift and a mask per access (and none of
+// the proxy objects of vector<bool>).
+class ByteMarks {
+public:
+    void assign(const std::vector<char>& initial) { bytes.assign(initial.begin(), initial.end()); }
+    bool test(int v) const { return bytes[v] != 0; }
+    void set(int v) { bytes[v] = 1; }
+    void prefetch(int v) const { __builtin_prefetch(bytes.data() + v, 1); }
+
+private:
+    std::vector<char> bytes;
+};
+
+class BitMarks {
+public:
+    void assign(const std::vector<char>& initial) {
+        words.assign((initial.size() + 63) / 64, 0);
+        for (size_t v = 0; v < initial.size(); ++v) {
+            if (initial[v]) {
+                set(static_cast<int>(v));
+            }
+        }
+    }
+    bool test(int v) const { return (words[v >> 6] >> (v & 63)) & 1; }
+    void set(int v) { words[v >> 6] |= uint64_t(1) << (v & 63); }
+    void prefetch(int v) const { __builtin_prefetch(words.data() + (v >> 6), 1); }
+
+private:
+    std::vector<uint64_t> words;
+};
+
+// How many neighbors ahead of the one being looked at the DFS prefetches marks and rows
+const int PREFETCH_DISTANCE = 4;
+
+// Rows whose iterators reach a later neighbor in O(1); on other rows (lists, decoded or matrix rows)
+// getting to it would cost as much as the miss that prefetching saves, so they are not prefetched
+template <typename Iterator>
+struct RandomAccessRow : std::false_type {};
+
+template <typename T>
+struct RandomAccessRow<const T*> : std::true_type {};
+
+template <>
+struct RandomAccessRow<std::vector<int>::const_iterator> : std::true_type {};
+
+// Function to prefetch where the neighbors of v are found; nothing for graphs without such an array
+template <typename Graph>
+inline void prefetchRow(const Graph&, int) {}
+
+template <typename Container, typename Allocator>
+inline void prefetchRow(const std::vector<Container, Allocator>& g, int v) {
+    __builtin_prefetch(&g[v]);
+}
+
+template <typename Offset, typename Target>
+inline void prefetchRow(const CSRView<Offset, Target>& g, int v) {
+    __builtin_prefetch(g.offsets + v);
+}
+
+// Finds the SCCs of a Graph with an Algorithm. The scratch buffers are kept, so a solver that is run
+// again on a graph of similar size does not allocate.
+template <typename Graph, typename Algorithm = Kosaraju, typename Marks = BitMarks>
+class SCC {
+public:
+    // Finds the SCCs of g
+    const Components& run(const Graph& g) {
+        NoVisitor visitor;
+        return run(g, visitor);
+    }
+
+    // Finds the SCCs of g, leaving out the vertices set in excluded (if given) and the edges touching them.
+    // A cancelled run returns no components.
+    template <typename Visitor>
+    const Components& run(const Graph& g, Visitor&& visitor, const std::vector<bool>* excluded = nullptr) {
+        start(Traits::vertexCount(g), excluded);
+        if (!searchSmall(g, visitor, Algorithm())) {
+            search(g, visitor, excluded, Algorithm());
+        }
+        return finish(visitor);
+    }
+
+    // Same as run(), with a transposed graph the caller already has (Kosaraju only; Tarjan ignores it)
+    template <typename Transposed, typename Visitor>
+    const Components& runWithTranspose(const Graph& g, const Transposed& transposed, Visitor&& visitor,
+                                       const std::vector<bool>* excluded = nullptr) {
+        start(Traits::vertexCount(g), excluded);
+        if (!searchSmall(g, visitor, Algorithm())) {  // A small graph is cheaper to transpose again as bits
+            searchWithTranspose(g, transposed, visitor, excluded, Algorithm());
+        }
+        return finish(visitor);
+    }
+
+    const Components& components() const { return result; }
+
+    // Turns the bitset kernel for graphs of up to SMALL_GRAPH_VERTICES vertices on (the default) or off
+    void useSmallGraphKernel(bool enabled) { smallGraphKernel = enabled; }
+
+    // Turns prefetching of the marks and rows of upcoming neighbors in the Kosaraju passes on (the default) or off
+    void usePrefetch(bool enabled) { prefetching = enabled; }
+
+    // Number of threads that build the transpose of large graphs (1, the default, stays on the caller's)
+    void setTransposeThreads(int threads) { transposeThreads = std::max(1, threads); }
+
+    // Moves the components of the last run out of the solver
+    Components release() {
+        Components released;
+        std::swap(released, result);
+        return released;
+    }
+
+private:
+    typedef GraphTraits<Graph> Traits;
+
+    // One vertex of an iterative DFS and the neighbors it still has to look at
+    template <typename Iterator>
+    struct Frame {
+        int vertex;
+        Iterator next;
+        Iterator last;
+    };
+
+    int n = 0;
+    bool cancelled = false;
+    bool smallGraphKernel = true;
+    bool prefetching = true;
+    int transposeThreads = 1;
+    std::vector<char> visited;       // Excluded vertices; Tarjan: also its on-stack and assigned states
+    Marks marks;                     // Kosaraju: vertices visited by the running pass
+    std::vector<int> order;          // Kosaraju: vertices by finishing time
+    std::vector<int> transposeOffsets, transposeTargets;  // Kosaraju: the transpose as CSR
+    std::vector<std::pair<int, int>> transposeScratch;     // Kosaraju: edges partitioned by target bucket
+    std::vector<int> low, index;     // Tarjan: lowlinks and discovery indices
+    std::vector<int> tarjanStack;    // Tarjan: vertices not assigned to a component yet
+    std::vector<Frame<typename Traits::Iterator>> frames;
+    Components result;
+
+    void start(int vertices, const std::vector<bool>* excluded) {
+        n = vertices;
+        cancelled = false;
+        result.clear();
+        visited.assign(n, 0);
+        if (excluded) {
+            for (int v = 0; v < n; ++v) {
+                visited[v] = (*excluded)[v];
+            }
+        }
+    }
+
+    template <typename Visitor>
+    const Components& finish(Visitor& visitor) {
+        if (cancelled) {
+            result.clear();  // Partial results are not SCCs
+        }
+        visitor.phase(DONE);
+        return result;
+    }
+
+    // Kosaraju on a small graph: the kernel sized for it at compile time; false if the graph is too large
+    template <typename Visitor>
+    bool searchSmall(const Graph& g, Visitor& visitor, Kosaraju) {
+        if (!smallGraphKernel || n > SMALL_GRAPH_VERTICES) {
+            return false;
+        }
+        bool completed = n <= 64 ? bitKosaraju<1>(g, n, visited, visitor, result)
+                                 : bitKosaraju<SMALL_GRAPH_VERTICES / 64>(g, n, visited, visitor, result);
+        cancelled = !completed;
+        return true;
+    }
+
+    template <typename Visitor>
+    bool searchSmall(const Graph&, Visitor&, Tarjan) {
+        return false;  // Tarjan is asked for by name, keep its order
+    }
+
+    template <typename Visitor>
+    void search(const Graph& g, Visitor& visitor, const std::vector<bool>*, Kosaraju) {
+        firstPass(g, visitor);
+        if (cancelled) {
+            return;
+        }
+        visitor.phase(TRANSPOSE);
+        transpose(g);
+        CSRView<> transposed(n, transposeOffsets.data(), transposeTargets.data());
+        secondPass(transposed, visitor);
+    }
+
+    template <typename Transposed, typename Visitor>
+    void searchWithTranspose(const Graph& g, const Transposed& transposed, Visitor& visitor,
+                             const std::vector<bool>*, Kosaraju) {
+        firstPass(g, visitor);
+        if (!cancelled) {
+            secondPass(transposed, visitor);
+        }
+    }
+
+    template <typename Transposed, typename Visitor>
+    void searchWithTranspose(const Graph& g, const Transposed&, Visitor& visitor, const std::vector<bool>* excluded,
+                             Tarjan) {
+        search(g, visitor, excluded, Tarjan());
+    }
+
+    // Kosaraju's first pass: vertices in order of finishing time, as the recursive fillOrder pushes them
+    template <typename Visitor>
+    void firstPass(const Graph& g, Visitor& visitor) {
+        visitor.phase(FIRST_PASS);
+        order.clear();
+        marks.assign(visited);  // Excluded vertices count as visited
+        for (int s = 0; s < n; ++s) {
+            if (marks.test(s)) {
+                continue;
+            }
+            if (visitor.cancelled()) {
+                cancelled = true;
+                return;
+            }
+            marks.set(s);
+            frames.push_back(Frame<typename Traits::Iterator>{s, Traits::begin(g, s), Traits::end(g, s)});
+            while (!frames.empty()) {
+                Frame<typename Traits::Iterator>& top = frames.back();
+                if (top.next != top.last) {
+                    int w = *top.next;
+                    ++top.next;
+                    prefetchAhead(g, top.next, top.last);
+                    if (!marks.test(w)) {  // Descend; top is not used after the push moves the frames
+                        if (visitor.cancelled()) {
+                            frames.clear();
+                            cancelled = true;
+                            return;
+                        }
+                        marks.set(w);
+                        frames.push_back(Frame<typename Traits::Iterator>{w, Traits::begin(g, w), Traits::end(g, w)});
+                        prefetchStart(g, frames.back().next, frames.back().last);
+                    }
+                } else {
+                    order.push_back(top.vertex);  // All neighbors are processed
+                    frames.pop_back();
+                }
+            }
+        }
+    }
+
+    // Function to build the transpose as CSR; every list keeps the sources in increasing order
+    void transpose(const Graph& g) { transposeCSR(g, transposeOffsets, transposeTargets, transposeThreads, transposeScratch); }
+
+    // Kosaraju's second pass: one preorder DFS of the transpose per component, latest finished vertex first
+    template <typename Transposed, typename Visitor>
+    void secondPass(const Transposed& transposed, Visitor& visitor) {
+        typedef GraphTraits<Transposed> TTraits;
+        visitor.phase(SECOND_PASS);
+        marks.assign(visited);  // The same exclusions again
+        std::vector<Frame<typename TTraits::Iterator>> stack;
+        for (int i = static_cast<int>(order.size()) - 1; i >= 0; --i) {
+            int s = order[i];
+            if (marks.test(s)) {
+                continue;
+            }
+            marks.set(s);
+            result.vertices.push_back(s);
+            stack.push_back(Frame<typename TTraits::Iterator>{s, TTraits::begin(transposed, s), TTraits::end(transposed, s)});
+            while (!stack.empty()) {
+                Frame<typename TTraits::Iterator>& top = stack.back();
+                if (top.next != top.last) {
+                    int w = *top.next;
+                    ++top.next;
+                    prefetchAhead(transposed, top.next, top.last);
+                    if (!marks.test(w)) {
+                        if (visitor.cancelled()) {
+                            cancelled = true;
+                            return;
+                        }
+                        marks.set(w);
+                        result.vertices.push_back(w);
+                        stack.push_back(Frame<typename TTraits::Iterator>{w, TTraits::begin(transposed, w),
+                                                                          TTraits::end(transposed, w)});
+                        prefetchStart(transposed, stack.back().next, stack.back().last);
+                    }
+                } else {
+                    stack.pop_back();
+                }
+            }
+            endComponent(visitor);
+        }
+    }
+
+    // Function to prefetch the marks of the first neighbors of a vertex the DFS just discovered;
+    // prefetchAhead keeps the rest of its row PREFETCH_DISTANCE neighbors ahead of the scan
+    template <typename G, typename Iterator>
+    void prefetchStart(const G& g, Iterator next, Iterator last) {
+        prefetchStart(g, next, last, RandomAccessRow<Iterator>());
+    }
+
+    template <typename G, typename Iterator>
+    void prefetchStart(const G&, Iterator next, Iterator last, std::true_type) {
+        if (prefetching) {
+            for (Iterator stop = last - next > PREFETCH_DISTANCE ? next + PREFETCH_DISTANCE : last; next != stop; ++next) {
+                marks.prefetch(*next);
+            }
+        }
+    }
+
+    template <typename G, typename Iterator>
+    void prefetchStart(const G&, Iterator, Iterator, std::false_type) {}
+
+    // Function to prefetch the mark and row of the neighbor PREFETCH_DISTANCE places after next
+    template <typename G, typename Iterator>
+    void prefetchAhead(const G& g, Iterator next, Iterator last) {
+        prefetchAhead(g, next, last, RandomAccessRow<Iterator>());
+    }
+
+    template <typename G, typename Iterator>
+    void prefetchAhead(const G& g, Iterator next, Iterator last, std::true_type) {
+        if (prefetching && last - next > PREFETCH_DISTANCE) {
+            int w = next[PREFETCH_DISTANCE];
+            marks.prefetch(w);
+            prefetchRow(g, w);
+        }
+    }
+
+    template <typename G, typename Iterator>
+    void prefetchAhead(const G&, Iterator, Iterator, std::false_type) {}
+
+    // Tarjan's algorithm with an explicit DFS stack; excluded vertices count as already visited and never enter
+    template <typename Visitor>
+    void search(const Graph& g, Visitor& visitor, const std::vector<bool>*, Tarjan) {
+        visitor.phase(FIRST_PASS);
+        index.assign(n, -1);
+        low.assign(n, 0);
+        tarjanStack.clear();
+        int counter = 0;
+        for (int s = 0; s < n; ++s) {
+            if (visited[s]) {
+                continue;
+            }
+            if (visitor.cancelled()) {
+                cancelled = true;
+                return;
+            }
+            discover(g, s, counter);
+            while (!frames.empty()) {
+                Frame<typename Traits::Iterator>& top = frames.back();
+                int v = top.vertex;
+                if (top.next != top.last) {
+                    int w = *top.next;
+                    ++top.next;
+                    if (index[w] < 0) {
+                        if (visited[w]) {
+                            continue;  // Excluded
+                        }
+                        if (visitor.cancelled()) {
+                            frames.clear();
+                            cancelled = true;
+                            return;
+                        }
+                        discover(g, w, counter);
+                    } else if (visited[w] == 1 && index[w] < low[v]) {  // Still on the stack
+                        low[v] = index[w];
+                    }
+                    continue;
+                }
+                frames.pop_back();
+                if (low[v] == index[v]) {  // v is the root of a component: pop it off the stack
+                    int w;
+                    do {
+                        w = tarjanStack.back();
+                        tarjanStack.pop_back();
+                        visited[w] = 2;  // Assigned to a component
+                        result.vertices.push_back(w);
+                    } while (w != v);
+                    endComponent(visitor);
+                }
+                if (!frames.empty() && low[v] < low[frames.back().vertex]) {
+                    low[frames.back().vertex] = low[v];
+                }
+            }
+        }
+    }
+
+    void discover(const Graph& g, int v, int& counter) {
+        index[v] = low[v] = counter++;
+        visited[v] = 1;  // On the stack
+        tarjanStack.push_back(v);
+        frames.push_back(Frame<typename Traits::Iterator>{v, Traits::begin(g, v), Traits::end(g, v)});
+    }
+
+    template <typename Visitor>
+    void endComponent(Visitor& visitor) {
+        int first = result.offsets.back();
+        result.offsets.push_back(static_cast<int>(result.vertices.size()));
+        visitor.component(result.vertices.data() + first, result.vertices.data() + result.vertices.size());
+    }
+};
+
+// Function to find the SCCs of a graph with a one-off solver
+template <typename Algorithm = Kosaraju, typename Graph>
+Components find(const Graph& g) {
+    SCC<Graph, Algorithm> solver;
+    solver.run(g);
+    return solver.release();
+}
+
+} // namespace scc
+
+#endif // SCC_HPP
@@ -0,0 +1,88 @@
+// Microbenchmark of SCC queries on small graphs: the bitset kernel the library picks for graphs of up to
+// SMALL_GRAPH_VERTICES vertices against the general iterative Kosaraju on the same graphs.
+// Checks that both find the same components before timing them.
+#include "scc.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+// Function to build a random graph with n vertices and about degree * n edges
+vector<vector<int>> randomGraph(int n, int degree, mt19937& rng) {
+    vector<vector<int>> adj(n);
+    for (int i = 0; i < degree * n; ++i) {
+        adj[rng() % n].push_back(rng() % n);
+    }
+    return adj;
+}
+
+// Function to get the components as sets, independent of the order they were found in
+set<vector<int>> componentSet(const scc::Components& sccs) {
+    set<vector<int>> result;
+    for (vector<int>& component : sccs.toVectors()) {
+        sort(component.begin(), component.end());
+        result.insert(component);
+    }
+    return result;
+}
+
+// Function to time repeated queries on the same graphs, in ns per query
+double benchQueries(const vector<vector<vector<int>>>& graphs, int rounds, bool smallKernel, long& checksum) {
+    scc::SCC<vector<vector<int>>> solver;  // Reused like the servers do, so its buffers stay allocated
+    solver.useSmallGraphKernel(smallKernel);
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (const vector<vector<int>>& graph : graphs) {
+            checksum += solver.run(graph).size();
+        }
+    }
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count() / (double(graphs.size()) * rounds);
+}
+
+// Main function: small_bench [rounds] [degree]
+int main(int argc, char* argv[]) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 2000;
+    int degree = argc > 2 ? atoi(argv[2]) : 2;
+    if (rounds < 1 || degree < 0) {
+        cerr << "Usage: " << argv[0] << " [rounds] [degree]" << endl;
+        return 1;
+    }
+
+    mt19937 rng(1);
+    long checksum = 0;
+    cout << "vertices  general ns/query  bitset ns/query  speedup" << endl;
+    for (int n = 8; n <= scc::SMALL_GRAPH_VERTICES; n *= 2) {
+        vector<vector<vector<int>>> graphs;  // Several graphs per size, so one lucky shape does not decide
+        for (int i = 0; i < 16; ++i) {
+            graphs.push_back(randomGraph(n, degree, rng));
+        }
+        scc::SCC<vector<vector<int>>> general;
+        general.useSmallGraphKernel(false);
+        for (const vector<vector<int>>& graph : graphs) {
+            if (componentSet(general.run(graph)) != componentSet(scc::find(graph))) {
+                cerr << "Components differ on a graph with " << n << " vertices" << endl;
+                return 1;
+            }
+        }
+
+        benchQueries(graphs, rounds / 10 + 1, false, checksum);  // Warm up the caches and the allocator
+        double generalNs = benchQueries(graphs, rounds, false, checksum);
+        double bitsetNs = benchQueries(graphs, rounds, true, checksum);
+        cout.width(8);
+        cout << n << "  ";
+        cout.width(16);
+        cout << generalNs << "  ";
+        cout.width(15);
+        cout << bitsetNs << "  ";
+        cout.width(6);
+        cout << generalNs / bitsetNs << "x" << endl;
+    }
+    cerr << checksum << endl;  // Keeps the work observable
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Microbenchmark of building the transpose of a large random graph: one push_back per edge into
+// vector<vector<int>> (what the exercises used to do), a plain counting sort into CSR, and
+// transposeCSR with its radix-partitioned scatter on 1 .. max threads. Checks that all of them give
+// the same rows before reporting edges per second.
+#include "scc.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// Function to get the edges per second of the time since start
+double edgesPerSecond(long long edges, Clock::time_point start) {
+    chrono::duration<double> elapsed = Clock::now() - start;
+    return edges / elapsed.count();
+}
+
+// Counting sort straight into the transposed rows, one random write per edge
+void countingTranspose(int n, const vector<int>& offsets, const vector<int>& targets, vector<int>& tOffsets,
+                       vector<int>& tTargets) {
+    tOffsets.assign(n + 1, 0);
+    for (int target : targets) {
+        ++tOffsets[target + 1];
+    }
+    for (int v = 0; v < n; ++v) {
+        tOffsets[v + 1] += tOffsets[v];
+    }
+    tTargets.resize(targets.size());
+    vector<int> next(tOffsets.begin(), tOffsets.end() - 1);
+    for (int v = 0; v < n; ++v) {
+        for (int i = offsets[v]; i < offsets[v + 1]; ++i) {
+            tTargets[next[targets[i]]++] = v;
+        }
+    }
+}
+
+// Main function: transpose_bench [vertices] [edges] [max threads]
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 1 << 20;
+    long long m = argc > 2 ? atoll(argv[2]) : 8LL << 20;
+    int maxThreads = argc > 3 ? atoi(argv[3]) : max(1u, thread::hardware_concurrency());
+    if (n < 1 || m < 0 || m > 1LL << 30 || maxThreads < 1) {
+        cerr << "Usage: " << argv[0] << " [vertices] [edges, at most 2^30] [max threads]" << endl;
+        return 1;
+    }
+
+    mt19937 rng(1);  // Random graph as CSR, rows of uniform length give no bucket an easy time
+    vector<int> offsets(n + 1), targets(m);
+    for (int v = 0; v <= n; ++v) {
+        offsets[v] = static_cast<int>(m * v / n);
+    }
+    for (long long i = 0; i < m; ++i) {
+        targets[i] = rng() % n;
+    }
+    scc::CSRView<> graph(n, offsets.data(), targets.data());
+    cout << n << " vertices, " << m << " edges" << endl;
+
+    Clock::time_point start = Clock::now();
+    {
+        vector<vector<int>> transposedAdj(n);
+        for (int v = 0; v < n; ++v) {
+            for (int i = offsets[v]; i < offsets[v + 1]; ++i) {
+                transposedAdj[targets[i]].push_back(v);
+            }
+        }
+    }
+    cout << "push_back per edge:    " << edgesPerSecond(m, start) / 1e6 << " Medges/s" << endl;
+
+    vector<int> expectedOffsets, expectedTargets;
+    start = Clock::now();
+    countingTranspose(n, offsets, targets, expectedOffsets, expectedTargets);
+    cout << "counting sort:         " << edgesPerSecond(m, start) / 1e6 << " Medges/s" << endl;
+
+    vector<int> tOffsets, tTargets;
+    vector<pair<int, int>> scratch;
+    scc::transposeCSR(graph, tOffsets, tTargets, 1, scratch);  // Warm up: the scratch space is reused
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        start = Clock::now();
+        scc::transposeCSR(graph, tOffsets, tTargets, threads, scratch);
+        double rate = edgesPerSecond(m, start);
+        if (tOffsets != expectedOffsets || tTargets != expectedTargets) {
+            cerr << "transposeCSR on " << threads << " threads differs from the counting sort" << endl;
+            return 1;
+        }
+        cout << "partitioned, " << threads << (threads == 1 ? " thread:  " : " threads: ") << rate / 1e6
+             << " Medges/s" << endl;
+    }
+    return 0;
+}
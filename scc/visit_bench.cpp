@@ -0,0 +1,122 @@
+// Benchmark of the visited marks of the Kosaraju passes on a random power-law graph: vector<bool>
+// (what the exercises used before the library), ByteMarks and BitMarks, each with and without
+// prefetching the marks and rows of upcoming neighbors, on vector<vector<int>> and CSR adjacency.
+// The transpose is built beforehand, so the times are the two DFS passes only.
+#include "scc.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+// vector<bool> marks, for comparison: a proxy object and a bit mask per access
+class BoolMarks {
+public:
+    void assign(const vector<char>& initial) { bits.assign(initial.begin(), initial.end()); }
+    bool test(int v) const { return bits[v]; }
+    void set(int v) { bits[v] = true; }
+    void prefetch(int) const {}
+
+private:
+    vector<bool> bits;
+};
+
+// Function to build a Chung-Lu graph: both ends of every edge are drawn with probability proportional
+// to (rank + 1)^(-1 / (exponent - 1)), so the degrees follow a power law; hubs get random ids
+vector<vector<int>> powerLawGraph(int n, long long m, double exponent, mt19937& rng) {
+    vector<double> cumulative(n);
+    double total = 0;
+    for (int rank = 0; rank < n; ++rank) {
+        total += pow(rank + 1.0, -1.0 / (exponent - 1.0));
+        cumulative[rank] = total;
+    }
+    vector<int> id(n);
+    for (int v = 0; v < n; ++v) {
+        id[v] = v;
+    }
+    shuffle(id.begin(), id.end(), rng);
+    uniform_real_distribution<double> draw(0, total);
+    auto pick = [&]() {
+        int rank = upper_bound(cumulative.begin(), cumulative.end(), draw(rng)) - cumulative.begin();
+        return id[min(rank, n - 1)];
+    };
+    vector<vector<int>> adj(n);
+    for (long long i = 0; i < m; ++i) {
+        int u = pick();
+        adj[u].push_back(pick());
+    }
+    return adj;
+}
+
+// Function to time the passes of one solver configuration, best of rounds, in ms
+template <typename Graph, typename Marks>
+double timePasses(const Graph& g, const scc::CSRView<>& transposed, bool prefetch, int rounds,
+                  const scc::Components& expected) {
+    scc::SCC<Graph, scc::Kosaraju, Marks> solver;
+    solver.usePrefetch(prefetch);
+    double best = 1e300;
+    for (int r = 0; r < rounds; ++r) {
+        auto start = chrono::steady_clock::now();
+        const scc::Components& sccs = solver.runWithTranspose(g, transposed, scc::NoVisitor());
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+        best = min(best, elapsed.count());
+        if (sccs.vertices != expected.vertices || sccs.offsets != expected.offsets) {
+            cerr << "Marks configurations disagree" << endl;
+            exit(1);
+        }
+    }
+    return best;
+}
+
+// Function to print one row of the table: every marks type, without and with prefetching
+template <typename Graph>
+void benchRepresentation(const char* name, const Graph& g, const scc::CSRView<>& transposed, int rounds) {
+    scc::Components expected = scc::find(g);
+    cout << "  " << name << endl;
+    cout << "    vector<bool>:           " << timePasses<Graph, BoolMarks>(g, transposed, false, rounds, expected)
+         << " ms" << endl;
+    cout << "    ByteMarks:              " << timePasses<Graph, scc::ByteMarks>(g, transposed, false, rounds, expected)
+         << " ms" << endl;
+    cout << "    ByteMarks + prefetch:   " << timePasses<Graph, scc::ByteMarks>(g, transposed, true, rounds, expected)
+         << " ms" << endl;
+    cout << "    BitMarks:               " << timePasses<Graph, scc::BitMarks>(g, transposed, false, rounds, expected)
+         << " ms" << endl;
+    cout << "    BitMarks + prefetch:    " << timePasses<Graph, scc::BitMarks>(g, transposed, true, rounds, expected)
+         << " ms" << endl;
+}
+
+// Main function: visit_bench [vertices] [edges] [exponent] [rounds]
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 1 << 20;
+    long long m = argc > 2 ? atoll(argv[2]) : 8LL << 20;
+    double exponent = argc > 3 ? atof(argv[3]) : 2.1;
+    int rounds = argc > 4 ? atoi(argv[4]) : 3;
+    if (n <= scc::SMALL_GRAPH_VERTICES || m < 0 || m > 1LL << 30 || exponent <= 1 || rounds < 1) {
+        cerr << "Usage: " << argv[0] << " [vertices > " << scc::SMALL_GRAPH_VERTICES
+             << "] [edges, at most 2^30] [exponent > 1] [rounds]" << endl;
+        return 1;
+    }
+
+    mt19937 rng(1);
+    vector<vector<int>> adj = powerLawGraph(n, m, exponent, rng);
+    vector<int> offsets(n + 1, 0), targets;  // The same graph as CSR
+    targets.reserve(m);
+    for (int v = 0; v < n; ++v) {
+        targets.insert(targets.end(), adj[v].begin(), adj[v].end());
+        offsets[v + 1] = static_cast<int>(targets.size());
+    }
+    scc::CSRView<> csr(n, offsets.data(), targets.data());
+    vector<int> tOffsets, tTargets;
+    vector<pair<int, int>> scratch;
+    scc::transposeCSR(csr, tOffsets, tTargets, 1, scratch);
+    scc::CSRView<> transposed(n, tOffsets.data(), tTargets.data());
+
+    cout << n << " vertices, " << m << " edges, degree exponent " << exponent << ", best of " << rounds << endl;
+    benchRepresentation("vector<vector<int>>", adj, transposed, rounds);
+    benchRepresentation("CSR", csr, transposed, rounds);
+    return 0;
+}